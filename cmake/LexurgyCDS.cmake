@@ -0,0 +1,34 @@
+## ============================================================================
+##  Generate a class-data-sharing archive for the Lexurgy server.
+## ============================================================================
+##
+## Usage: cmake -DJAVA=<java> -DCLASSPATH=<classpath> -DINPUT=<requests>
+##              -DOUTPUT=<archive> -P LexurgyCDS.cmake
+##
+## This runs the Lexurgy server once on a few representative requests and
+## dumps every class that was loaded along the way into the archive when
+## the JVM exits. Starting the server with that archive lets the JVM map
+## those classes in directly instead of loading and verifying them from
+## the jars every time.
+##
+## Failing to create the archive is not an error: Smyth just starts
+## Lexurgy without it in that case. We still write an empty archive so
+## the build doesn’t try (and fail) again every time; Smyth ignores empty
+## archives.
+file(REMOVE "${OUTPUT}")
+execute_process(
+    COMMAND "${JAVA}"
+        -XX:ArchiveClassesAtExit=${OUTPUT}
+        -cp "${CLASSPATH}"
+        com.meamoria.lexurgy.cli.MainKt server
+    INPUT_FILE "${INPUT}"
+    OUTPUT_QUIET
+    ERROR_VARIABLE error
+    RESULT_VARIABLE result
+    TIMEOUT 300
+)
+
+if (NOT result EQUAL 0 OR NOT EXISTS "${OUTPUT}")
+    message(WARNING "Failed to create Lexurgy CDS archive (${result}): ${error}")
+    file(WRITE "${OUTPUT}" "")
+endif()
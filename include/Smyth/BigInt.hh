@@ -0,0 +1,71 @@
+#ifndef SMYTH_BIG_INT_HH
+#define SMYTH_BIG_INT_HH
+
+#include <bit>
+#include <compare>
+#include <limits>
+#include <Smyth/Utils.hh>
+#include <string>
+#include <vector>
+
+namespace smyth {
+/// Arbitrary-precision unsigned integer.
+///
+/// This only supports what we need for counting things, i.e. addition,
+/// subtraction, comparison, and printing.
+class BigInt {
+    /// Little-endian, without leading zeroes; zero is empty.
+    std::vector<u32> limbs;
+
+public:
+    BigInt() = default;
+    BigInt(u64 value);
+
+    /// Get a uniformly distributed random number in [0, bound). The
+    /// bound must not be zero.
+    template <typename Rng>
+    static auto Below(const BigInt& bound, Rng& rng) -> BigInt;
+
+    /// Whether this is zero.
+    auto is_zero() const -> bool { return limbs.empty(); }
+
+    /// Convert to a decimal string.
+    auto str() const -> std::string;
+
+    auto operator+=(const BigInt& other) -> BigInt&;
+
+    /// The result must not be negative.
+    auto operator-=(const BigInt& other) -> BigInt&;
+
+    friend auto operator+(BigInt a, const BigInt& b) -> BigInt { return a += b; }
+    friend auto operator-(BigInt a, const BigInt& b) -> BigInt { return a -= b; }
+    friend auto operator<=>(const BigInt& a, const BigInt& b) -> std::strong_ordering;
+    friend auto operator==(const BigInt& a, const BigInt& b) -> bool = default;
+
+private:
+    void Trim();
+};
+
+auto operator<=>(const BigInt& a, const BigInt& b) -> std::strong_ordering;
+} // namespace smyth
+
+template <typename Rng>
+auto smyth::BigInt::Below(const BigInt& bound, Rng& rng) -> BigInt {
+    static_assert(Rng::min() == 0 and Rng::max() == std::numeric_limits<u32>::max());
+    Assert(not bound.is_zero(), "Bound must not be zero");
+
+    // Generate random numbers with as many bits as the bound until we
+    // get one that is smaller; this takes fewer than 2 tries on average.
+    auto top = bound.limbs.back();
+    auto mask = std::numeric_limits<u32>::max() >> std::countl_zero(top);
+    BigInt n;
+    do {
+        n.limbs.resize(bound.limbs.size());
+        for (auto& l : n.limbs) l = u32(rng());
+        n.limbs.back() &= mask;
+        n.Trim();
+    } while (n >= bound);
+    return n;
+}
+
+#endif // SMYTH_BIG_INT_HH
@@ -0,0 +1,61 @@
+#ifndef SMYTH_CHUNKED_TEXT_HH
+#define SMYTH_CHUNKED_TEXT_HH
+
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+#include <Smyth/Utils.hh>
+
+namespace smyth {
+/// Immutable text, stored as a list of chunks that each end at a line
+/// break (except possibly the last one).
+///
+/// Copying this is cheap since the chunks are shared, so it can be used
+/// to take snapshots of huge documents. Files are loaded by mapping them
+/// into memory and decoding the chunks in parallel; text that is already
+/// in memory is split into chunks as well.
+class ChunkedText {
+    QList<QString> parts;
+    qsizetype total_size = 0;
+    qsizetype line_count = 0;
+
+public:
+    /// Approximate size of a chunk, in bytes of UTF-8 or UTF-16 code
+    /// units, depending on what the text is created from.
+    static constexpr qsizetype ChunkSize = 1 << 20;
+
+    ChunkedText() = default;
+
+    /// Split text into chunks at line breaks. This doesn’t copy anything
+    /// if the text is small enough to fit in a single chunk.
+    explicit ChunkedText(QString text);
+
+    /// Decode UTF-8 text, in parallel if it is large.
+    static auto FromUtf8(QByteArrayView data) -> ChunkedText;
+
+    /// Load a UTF-8 file.
+    static auto Map(const QString& path) -> Result<ChunkedText>;
+
+    /// Get the chunks. Since every chunk but the last ends at a line
+    /// break, they can be processed line by line without joining them.
+    auto chunks() const -> const QList<QString>& { return parts; }
+
+    /// Get the number of lines in the text.
+    auto lines() const -> qsizetype { return line_count; }
+
+    /// Get the first few lines of the text.
+    auto preview(qsizetype max_lines) const -> QString;
+
+    /// Get the size of the text, in UTF-16 code units.
+    auto size() const -> qsizetype { return total_size; }
+
+    /// Get the entire text. This copies everything if the text consists
+    /// of more than one chunk; prefer chunks() for huge texts.
+    auto str() const -> QString;
+
+private:
+    void Add(QString chunk);
+};
+} // namespace smyth
+
+#endif // SMYTH_CHUNKED_TEXT_HH
@@ -0,0 +1,111 @@
+#ifndef SMYTH_NATIVE_ENGINE_HH
+#define SMYTH_NATIVE_ENGINE_HH
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <Smyth/Utils.hh>
+#include <span>
+#include <vector>
+
+namespace smyth::sca {
+/// Native implementation of a small subset of Lexurgy.
+///
+/// Lexurgy is slow to start and every request has to go through a JVM,
+/// which is a lot of overhead for the simple rules that most sound changes
+/// consist of. This supports
+///
+///   - class declarations: `Class vowel {a, e, i, o, u}`;
+///   - named rules, each of which has one or more expressions of the form
+///     `a => b` or `a => b / before _ after`, where both sides are made up
+///     of literal characters, `@class`es, and `{x, y}` alternatives, and
+///     `*` on the right-hand side deletes the match;
+///   - `$` as a word boundary in environments.
+///
+/// Expressions in the same rule apply simultaneously: at each position in
+/// the word, the first expression that matches wins, and environments are
+/// always matched against the word as it was before the rule was applied.
+///
+/// Anything else (features, syllables, romanisers, rule modifiers, etc.)
+/// is rejected by Compile(), in which case Lexurgy must be used instead.
+class Engine {
+    /// One element of a pattern; this matches one of several strings,
+    /// or a word boundary if there are none.
+    struct Element {
+        QStringList alternatives;
+
+        /// Whether this came from a class or `{...}`; only those can be
+        /// mapped to other sets in the output.
+        bool is_set = false;
+    };
+
+    using Pattern = std::vector<Element>;
+
+    /// A single expansion of the left-hand side of an expression.
+    struct Alternative {
+        QString from;
+        QString to;
+        u32 expression;
+    };
+
+    struct Expression {
+        Pattern before;
+        Pattern after;
+    };
+
+    struct Rule {
+        QString name;
+        std::vector<Expression> expressions;
+
+        /// Every way the rule can match, in order of priority.
+        std::vector<Alternative> alternatives;
+
+        /// Indices into ‘alternatives’ by their first character.
+        QHash<QChar, std::vector<u32>> by_first_char;
+    };
+
+    std::vector<Rule> rules;
+
+    Engine() = default;
+
+public:
+    /// Compile sound changes; fails if they use anything we don’t support.
+    static auto Compile(QStringView changes) -> Result<Engine>;
+
+    /// Apply the sound changes to a number of words; the result contains
+    /// one line per word. Large inputs are processed on several threads.
+    ///
+    /// This fails if a word contains anything that Lexurgy may treat
+    /// differently from a plain sequence of characters, or if a rule to
+    /// start at or stop before doesn’t exist; use Lexurgy for those.
+    auto apply(
+        std::span<const QStringView> words,
+        QStringView start_at = {},
+        QStringView stop_before = {}
+    ) const -> Result<QString>;
+
+private:
+    /// Apply a rule to a single word.
+    static void ApplyRule(const Rule& r, QStringView word, QString& out);
+
+    /// Check whether a pattern matches after or before a position.
+    static bool MatchAfter(std::span<const Element> p, QStringView word, qsizetype pos);
+    static bool MatchBefore(std::span<const Element> p, QStringView word, qsizetype pos);
+
+    /// Parse and expand an expression and add it to a rule.
+    static auto ParseExpression(
+        Rule& r,
+        QStringView text,
+        const QHash<QString, QStringList>& classes
+    ) -> Result<>;
+
+    /// Parse the elements of one side of an expression.
+    static auto ParsePattern(
+        QStringView text,
+        const QHash<QString, QStringList>& classes,
+        bool environment
+    ) -> Result<Pattern>;
+};
+} // namespace smyth::sca
+
+#endif // SMYTH_NATIVE_ENGINE_HH
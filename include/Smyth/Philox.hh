@@ -0,0 +1,71 @@
+#ifndef SMYTH_PHILOX_HH
+#define SMYTH_PHILOX_HH
+
+#include <array>
+#include <limits>
+#include <Smyth/Utils.hh>
+
+namespace smyth {
+/// Philox4x32-10 counter-based random number generator.
+///
+/// The output is a pure function of a key (the seed), a stream number,
+/// a substream number, and a position within the substream, so every
+/// substream is independent of all others, and it doesn’t matter in what
+/// order or on what thread they’re consumed. A substream has 2^32 blocks
+/// of 4 numbers. This satisfies UniformRandomBitGenerator.
+///
+/// See Salmon et al., ‘Parallel Random Numbers: As Easy as 1, 2, 3’.
+class Philox {
+    std::array<u32, 4> counter;
+    std::array<u32, 2> key;
+    std::array<u32, 4> block{};
+    u32 index = 4;
+
+public:
+    using result_type = u32;
+
+    /// Create a generator for a substream of a stream.
+    constexpr Philox(u64 seed, u64 stream, u32 substream = 0)
+        : counter{0, substream, u32(stream), u32(stream >> 32)},
+          key{u32(seed), u32(seed >> 32)} {}
+
+    static constexpr auto min() -> u32 { return 0; }
+    static constexpr auto max() -> u32 { return std::numeric_limits<u32>::max(); }
+
+    /// Get the next number in the stream.
+    constexpr auto operator()() -> u32 {
+        if (index == 4) {
+            block = Block(counter, key);
+            index = 0;
+            counter[0]++;
+        }
+
+        return block[index++];
+    }
+
+    /// Compute the block for a counter.
+    static constexpr auto Block(std::array<u32, 4> ctr, std::array<u32, 2> k) -> std::array<u32, 4> {
+        constexpr u32 M0 = 0xD251'1F53;
+        constexpr u32 M1 = 0xCD9E'8D57;
+        constexpr u32 W0 = 0x9E37'79B9;
+        constexpr u32 W1 = 0xBB67'AE85;
+        for (int round = 0; round < 10; round++) {
+            auto p0 = u64(M0) * ctr[0];
+            auto p1 = u64(M1) * ctr[2];
+            ctr = {
+                u32(p1 >> 32) ^ ctr[1] ^ k[0],
+                u32(p1),
+                u32(p0 >> 32) ^ ctr[3] ^ k[1],
+                u32(p0),
+            };
+
+            k[0] += W0;
+            k[1] += W1;
+        }
+
+        return ctr;
+    }
+};
+} // namespace smyth
+
+#endif // SMYTH_PHILOX_HH
@@ -0,0 +1,101 @@
+#ifndef SMYTH_TRACE_HH
+#define SMYTH_TRACE_HH
+
+#include <chrono>
+#include <QString>
+#include <Smyth/Utils.hh>
+#include <string_view>
+#include <vector>
+
+/// Lightweight timing instrumentation.
+///
+/// Stages of a pipeline are measured with scoped timers; every span that
+/// is recorded on a thread while a run is current on that thread (see
+/// `Scope`) is attributed to that run, so we can show how long each stage
+/// of the last run took. Code that continues a run asynchronously must
+/// pass its id along and make it current again. A bounded history of
+/// spans is kept so it can be exported as a Chrome trace file (which can
+/// be viewed in chrome://tracing or Perfetto).
+namespace smyth::trace {
+using Clock = std::chrono::steady_clock;
+
+/// Identifies a run; 0 means ‘no run’.
+using RunId = u64;
+
+/// How long each stage of a run took.
+struct Breakdown {
+    /// Time from the start to the end of the run.
+    Clock::duration total{};
+
+    /// Total time spent in each stage, in the order in which the stages
+    /// were first entered. A stage may overlap with other stages, e.g.
+    /// if it measures a round trip.
+    std::vector<std::pair<std::string_view, Clock::duration>> stages;
+};
+
+/// Measures the time until it goes out of scope.
+class Timer {
+    LIBBASE_IMMOVABLE(Timer);
+    std::string_view name;
+    Clock::time_point start = Clock::now();
+
+public:
+    /// The name must outlive the trace history; use a string literal.
+    explicit Timer(std::string_view name) : name{name} {}
+    ~Timer();
+};
+
+/// Makes a run current on this thread until it goes out of scope.
+class Scope {
+    LIBBASE_IMMOVABLE(Scope);
+    RunId previous;
+
+public:
+    explicit Scope(RunId run);
+    ~Scope();
+};
+
+/// A run that is ended when it goes out of scope, unless it has been
+/// ended explicitly before that; this makes sure that runs that fail or
+/// are cancelled are ended too.
+class Run {
+    LIBBASE_IMMOVABLE(Run);
+    RunId run_id;
+    bool ended = false;
+
+public:
+    /// The name must outlive the trace history; use a string literal.
+    explicit Run(std::string_view name);
+    ~Run();
+
+    /// Get the id of this run.
+    auto id() const -> RunId { return run_id; }
+
+    /// End the run and get its breakdown.
+    auto end() -> Breakdown;
+};
+
+/// Start a new run. This does not make it current.
+auto BeginRun(std::string_view name) -> RunId;
+
+/// Get the run that is current on this thread, if any.
+auto CurrentRun() -> RunId;
+
+/// End a run and get its breakdown.
+auto EndRun(RunId run) -> Breakdown;
+
+/// Write the history to a file in Chrome’s trace event format.
+auto ExportChromeTrace(const QString& path) -> Result<>;
+
+/// Record a span that can’t be measured with a Timer, e.g. because it
+/// starts and ends in different callbacks. The same requirements as for
+/// Timer apply to the name.
+void Record(
+    std::string_view name,
+    Clock::time_point start,
+    Clock::time_point end = Clock::now(),
+    RunId run = CurrentRun()
+);
+} // namespace smyth::trace
+
+#endif // SMYTH_TRACE_HH
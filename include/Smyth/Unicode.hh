@@ -0,0 +1,23 @@
+#ifndef SMYTH_UNICODE_HH
+#define SMYTH_UNICODE_HH
+
+#include <base/Text.hh>
+#include <QString>
+#include <Smyth/Utils.hh>
+
+namespace smyth {
+/// Fold text for comparing words: this folds case, applies NFKD, and
+/// removes combining marks, so e.g. ‘Å’, ‘å’, and ‘a’ fold to the same
+/// text.
+auto Fold(QStringView text) -> Result<QString>;
+
+/// Normalise text in place.
+///
+/// Text that is already normalised is left untouched and not copied,
+/// so this is cheap to call on text that is usually normalised anyway.
+/// Large texts are split into chunks at line breaks, and the chunks are
+/// normalised in parallel.
+auto Normalise(QString& text, text::NormalisationForm form) -> Result<>;
+} // namespace smyth
+
+#endif // SMYTH_UNICODE_HH
@@ -0,0 +1,257 @@
+#ifndef SMYTH_WORD_GENERATOR_HH
+#define SMYTH_WORD_GENERATOR_HH
+
+#include <QHash>
+#include <QString>
+#include <Smyth/BigInt.hh>
+#include <Smyth/Utils.hh>
+#include <span>
+#include <vector>
+
+namespace smyth::wordgen {
+class Generator;
+class WordIndex;
+
+/// Get a random seed for generating words.
+auto RandomSeed() -> u64;
+
+/// The set of distinct words a generator can produce.
+///
+/// This is a deterministic automaton over characters, so every word
+/// corresponds to exactly one path through it, even if the generator
+/// can produce the same word in several ways (e.g. `C = t, th, h` with
+/// the pattern `C(C)` produces ‘th’ twice). Counting paths of each length
+/// thus counts distinct words, and we can map any number in [0, size())
+/// to a distinct word, which lets us sample words uniformly without
+/// having to reject duplicates.
+///
+/// Words are ranked by length and then by the UTF-16 code units they
+/// consist of.
+class WordSpace {
+    friend Generator;
+
+    struct State {
+        u32 first;
+        u32 count;
+        bool accept;
+    };
+
+    struct Transition {
+        QChar c;
+        u32 target;
+    };
+
+    /// State 0 is the start state; the transitions of a state are stored
+    /// in ‘transitions’, starting at ‘first’, and sorted by character.
+    std::vector<State> states;
+    std::vector<Transition> transitions;
+
+    /// For each state, the number of words of each length that can be
+    /// spelt starting at that state.
+    std::vector<std::vector<BigInt>> ways;
+
+    /// The number of words of each length.
+    std::vector<BigInt> by_length;
+
+    /// The total number of words.
+    BigInt total;
+
+    WordSpace() = default;
+
+public:
+    /// Maximum number of states; this is only a concern for patterns
+    /// that generate truly absurd numbers of words.
+    static constexpr usz MaxStates = 500'000;
+
+    /// Get the number of distinct words of each length.
+    auto counts() const -> std::span<const BigInt> { return by_length; }
+
+    /// Generate words uniformly at random, one per line. The result only
+    /// depends on the seed. If ‘exclude’ is set, the words are unique and
+    /// don’t occur in it, compared after folding.
+    auto sample(usz count, u64 seed, const WordIndex* exclude = nullptr) const -> Result<QString>;
+
+    /// Get the total number of distinct words.
+    auto size() const -> const BigInt& { return total; }
+
+    /// Get the word with the given rank, which must be less than size().
+    auto unrank(BigInt rank) const -> QString;
+
+private:
+    void Count(u32 state);
+    auto Transitions(u32 state) const -> std::span<const Transition>;
+};
+
+/// Generates random words from a set of classes and a phonotactic pattern.
+///
+/// Classes are defined one per line, e.g. `C = p, t, k`; the name of a
+/// class is a single character, and its members are arbitrary strings.
+/// Members can be given a weight, e.g. `C = p:5, t:3, k`; members without
+/// one have a weight of 1. The pattern consists of
+///
+///   - class names, which are replaced with a random member of the class;
+///   - `(...)`, which contains an optional part of the pattern;
+///   - `[...|...]`, which contains several alternatives, one of which is
+///     picked at random; these can be weighted as well, e.g. `[CV:3|V]`;
+///   - any other character, which is inserted as is.
+///
+/// Lines of the form `reject: aa, hh` define filters: words that contain
+/// any of those strings are never generated.
+///
+/// Whitespace in the pattern is ignored. The pattern is compiled into a
+/// small automaton, and generating a word is a random walk through it.
+/// Weighted choices use alias tables, so every choice takes constant time
+/// no matter how many members a class has.
+class Generator {
+    /// A node in the automaton.
+    struct Node {
+        enum struct Kind : u8 {
+            /// Append a random member of a class and go to ‘next’.
+            Emit,
+
+            /// Go to a random one of ‘count’ nodes in ‘targets’, starting
+            /// at ‘index’.
+            Choose,
+
+            /// The word is complete.
+            Accept,
+        };
+
+        Kind kind;
+
+        /// Choose: whether the targets have an alias table.
+        bool weighted;
+
+        /// Emit: the class to pick from; Choose: the first target.
+        u32 index;
+
+        /// Choose: the number of targets.
+        u32 count;
+
+        /// Emit: the node to go to next.
+        u32 next;
+    };
+
+    /// A class; its members are stored in ‘items’, starting at ‘first’.
+    struct Class {
+        QChar name;
+        u32 first;
+        u32 count;
+
+        /// Whether the members have an alias table.
+        bool weighted;
+    };
+
+    /// A member of a class; this is a slice of ‘pool’.
+    struct Item {
+        u32 offset;
+        u32 size;
+        double weight;
+    };
+
+    /// An entry in an alias table: having picked an entry uniformly at
+    /// random, keep it with probability ‘threshold / 2^32’, and take
+    /// ‘other’ instead otherwise.
+    struct Alias {
+        u64 threshold;
+        u32 other;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<u32> targets;
+    std::vector<Alias> target_aliases;
+    std::vector<Class> classes;
+    std::vector<Item> items;
+    std::vector<Alias> item_aliases;
+    QString pool;
+    u32 start = 0;
+
+    /// A state in an Aho-Corasick automaton that finds rejected strings;
+    /// state 0 is the start state.
+    struct FilterState {
+        QHash<QChar, u32> next;
+        u32 fail = 0;
+        bool match = false;
+    };
+
+    std::vector<FilterState> filter = std::vector<FilterState>(1);
+
+    Generator() = default;
+
+public:
+    /// Maximum number of words that can be generated at once.
+    static constexpr usz MaxWords = 10'000'000;
+
+    /// Generated words.
+    struct Words {
+        /// The words, one per line.
+        QString text;
+
+        /// How often each member of each class was picked.
+        std::vector<u64> draws;
+
+        /// How many candidates were rejected by filters.
+        u64 rejected = 0;
+
+        /// How many candidates were discarded as duplicates.
+        u64 duplicates = 0;
+    };
+
+    /// How often a member of a class was picked compared to how often
+    /// we’d expect it to be picked based on its weight.
+    struct Frequency {
+        QChar cls;
+        QString member;
+
+        /// Expected share of picks from this class.
+        double expected;
+
+        /// Actual share of picks from this class.
+        double actual;
+
+        /// How often this member was picked.
+        u64 draws;
+    };
+
+    /// Compile class definitions and a pattern.
+    static auto Compile(QStringView classes, QStringView pattern) -> Result<Generator>;
+
+    /// Get the distribution of class members in generated words; unnamed
+    /// classes (i.e. literals) are omitted.
+    auto frequencies(std::span<const u64> draws) const -> std::vector<Frequency>;
+
+    /// Generate words. Large numbers of words are generated on several
+    /// threads. This may produce fewer words than requested if almost all
+    /// words are rejected by filters or are duplicates.
+    ///
+    /// Every word is generated from its own random stream, so the result
+    /// only depends on the seed and not on the number of threads. If
+    /// ‘exclude’ is set, the words are unique and don’t occur in it,
+    /// compared after folding.
+    auto generate(usz count, u64 seed, const WordIndex* exclude = nullptr) const -> Result<Words>;
+
+    /// Whether there are any filters.
+    auto has_filters() const -> bool { return filter.size() > 1; }
+
+    /// Compute the set of distinct words this can generate, optionally
+    /// taking filters into account.
+    auto space(bool filtered = true) const -> Result<WordSpace>;
+
+private:
+    class Parser;
+
+    /// Build an alias table using Vose’s method.
+    static void BuildAliasTable(std::span<const double> weights, std::span<Alias> table);
+
+    /// Advance the filter automaton.
+    auto FilterStep(u32 state, QChar c) const -> u32;
+
+    template <typename Rng>
+    void Generate(Rng& rng, QString& out, std::vector<u32>& picks) const;
+
+    /// Check whether a word contains a rejected string.
+    auto Rejected(QStringView word) const -> bool;
+};
+} // namespace smyth::wordgen
+
+#endif // SMYTH_WORD_GENERATOR_HH
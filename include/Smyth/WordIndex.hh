@@ -0,0 +1,53 @@
+#ifndef SMYTH_WORD_INDEX_HH
+#define SMYTH_WORD_INDEX_HH
+
+#include <QSet>
+#include <QString>
+#include <Smyth/Utils.hh>
+#include <vector>
+
+namespace smyth::wordgen {
+/// A set of folded words (see `Fold()`) for finding duplicates quickly.
+///
+/// Large indices have a Bloom filter in front of the hash table: most
+/// words we look up aren’t in the index, and the filter rules almost all
+/// of those out without having to touch the table, which is much larger.
+class WordIndex {
+    QSet<QString> words;
+
+    /// Bloom filter; empty if the index is small.
+    std::vector<u64> bloom;
+
+public:
+    /// Only use a Bloom filter for at least this many words.
+    static constexpr usz MinBloomWords = 1 << 16;
+
+    /// Number of bits in the filter per word.
+    static constexpr usz BloomBitsPerWord = 10;
+
+    /// Number of bits to check per word.
+    static constexpr usz BloomHashes = 7;
+
+    /// Create an index for about this many words.
+    explicit WordIndex(usz expected_size = 0);
+
+    /// Create an index from words that are not folded yet.
+    static auto Build(const QStringList& words) -> Result<WordIndex>;
+
+    /// Check if the index contains a folded word.
+    auto contains(const QString& folded) const -> bool;
+
+    /// Add a folded word.
+    void insert(QString folded);
+
+    /// Get the number of words in the index.
+    auto size() const -> usz { return usz(words.size()); }
+
+private:
+    /// Call a function with the index of each filter bit of a word.
+    template <typename Callable>
+    void ForEachBit(const QString& folded, Callable cb) const;
+};
+} // namespace smyth::wordgen
+
+#endif // SMYTH_WORD_INDEX_HH
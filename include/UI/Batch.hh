@@ -0,0 +1,22 @@
+#ifndef SMYTH_UI_BATCH_HH
+#define SMYTH_UI_BATCH_HH
+
+#include <QStringList>
+
+namespace smyth::ui::batch {
+/// Run the ‘apply’ subcommand.
+///
+/// This applies sound changes to words read from a file or stdin and
+/// writes the results to stdout, without creating any widgets. It
+/// requires a QCoreApplication to exist. Returns the exit code.
+int Apply(const QStringList& args);
+
+/// Run the ‘bench’ subcommand.
+///
+/// This applies synthetic sound changes to increasing numbers of words
+/// and reports how long that takes as JSON. Like Apply(), it requires a
+/// QCoreApplication to exist. Returns the exit code.
+int Bench(const QStringList& args);
+} // namespace smyth::ui::batch
+
+#endif // SMYTH_UI_BATCH_HH
@@ -0,0 +1,92 @@
+#ifndef SMYTH_UI_JSINTERPOLATOR_HH
+#define SMYTH_UI_JSINTERPOLATOR_HH
+
+#include <condition_variable>
+#include <mutex>
+#include <QJSEngine>
+#include <QString>
+#include <thread>
+#include <UI/Smyth.hh>
+
+namespace smyth::ui {
+class JSInterpolator;
+} // namespace smyth::ui
+
+/// Evaluates JavaScript embedded in text between `§{` and `}§`.
+///
+/// The engine is kept around between evaluations. Expressions may have
+/// side effects that later ones depend on (e.g. defining a function and
+/// calling it later), so results are only reused as long as everything
+/// evaluated before them is unchanged: if the expressions in the text
+/// start with the ones we’ve evaluated last time, we reuse those results
+/// and only evaluate the rest, in the same engine; otherwise, we start
+/// over with a fresh engine.
+class smyth::ui::JSInterpolator {
+    LIBBASE_IMMOVABLE(JSInterpolator);
+
+public:
+    /// How long evaluating all expressions in a text may take at most.
+    static constexpr chr::milliseconds Budget{5'000};
+
+    struct Timing {
+        /// The expression that was evaluated.
+        QString expression;
+
+        /// How long it took to evaluate it.
+        chr::nanoseconds time;
+
+        /// Whether we reused the result of a previous evaluation.
+        bool cached;
+    };
+
+private:
+    /// An expression that has been evaluated in the current engine.
+    struct Entry {
+        QString expression;
+
+        /// The result, or nothing if it was null or undefined.
+        std::optional<QString> result;
+
+        /// How long it took to evaluate.
+        chr::nanoseconds time;
+    };
+
+    std::unique_ptr<QJSEngine> engine;
+    std::vector<Entry> history;
+    std::vector<Timing> last_timings;
+
+    /// The watchdog interrupts the engine if it runs past the deadline.
+    std::mutex watchdog_mutex;
+    std::condition_variable_any watchdog_cv;
+    std::optional<chr::steady_clock::time_point> deadline;
+    std::jthread watchdog;
+
+public:
+    JSInterpolator();
+    ~JSInterpolator() noexcept;
+
+    /// Replace every `§{}§` in a string with the result of evaluating the
+    /// JavaScript expression in it.
+    auto interpolate(QString& text) -> Result<>;
+
+    /// Throw away the engine and all cached results.
+    void reset();
+
+    /// Get how long each expression took during the last interpolation.
+    auto timings() const -> std::span<const Timing> { return last_timings; }
+
+private:
+    /// Evaluate a single expression.
+    auto Evaluate(
+        const QString& expr,
+        chr::steady_clock::time_point until
+    ) -> Result<std::optional<QString>>;
+
+    /// Create a new engine.
+    void Restart();
+
+    /// Watchdog thread.
+    void Watch(std::stop_token stop);
+};
+
+#endif // SMYTH_UI_JSINTERPOLATOR_HH
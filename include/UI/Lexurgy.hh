@@ -1,20 +1,137 @@
 #ifndef SMYTH_UI_LEXURGY_HH
 #define SMYTH_UI_LEXURGY_HH
 
+#include <chrono>
+#include <functional>
+#include <QList>
 #include <QString>
 #include <Smyth/Utils.hh>
 
 namespace smyth::lexurgy {
+/// Identifies a request that has been sent to Lexurgy.
+using RequestId = u64;
+
+/// Invoked with the result of a request once Lexurgy has responded.
+using Callback = std::function<void(Result<QString>)>;
+
+/// How long a single rule took to apply.
+struct RuleProfile {
+    /// The name of the rule, or empty for everything before the first
+    /// named rule.
+    QString rule;
+
+    /// How long it took Lexurgy to apply the rule, including the time it
+    /// takes to send the words to Lexurgy and back.
+    std::chrono::nanoseconds time;
+
+    /// How many words were changed by the rule.
+    usz words_changed;
+};
+
+/// Invoked with the result of profiling sound changes.
+using ProfileCallback = std::function<void(Result<std::vector<RuleProfile>>)>;
+
+/// Whether to use the native engine for sound changes that it supports.
+///
+/// The native engine is experimental and thus disabled unless the user
+/// enables it in the settings.
+enum struct NativeEngineMode {
+    /// Always use Lexurgy.
+    Disabled,
+
+    /// Use the native engine if possible, and Lexurgy otherwise.
+    Enabled,
+
+    /// Use both and report an error if their results differ.
+    Differential,
+};
+
 /// Apply sound changes.
+///
+/// This does not block: the request is queued and the callback is
+/// invoked on the GUI thread once the result arrives, unless the
+/// request is cancelled before that happens.
 auto Apply(
     QStringView words,
     QString changes,
     const QString& start_after,
-    const QString& stop_before
-) -> Result<QString>;
+    const QString& stop_before,
+    Callback cb
+) -> Result<RequestId>;
+
+/// Apply sound changes to text that is split into chunks, every one of
+/// which except the last must end at a line break. This is the same as
+/// joining the chunks and applying the changes to that, but doesn’t copy
+/// anything, which matters for huge inputs.
+auto Apply(
+    const QList<QString>& chunks,
+    QString changes,
+    const QString& start_after,
+    const QString& stop_before,
+    Callback cb
+) -> Result<RequestId>;
 
-/// Close the lexurgy process.
+/// Cancel a request, e.g. because it has been superseded by a newer
+/// one. Its callback will not be invoked. If the request has not been
+/// sent yet, it is dropped entirely; otherwise, its response is simply
+/// discarded when it arrives. Does nothing if the request has already
+/// completed.
+void Cancel(RequestId id);
+
+/// Drop all cached results without closing Lexurgy.
+void ClearCache();
+
+/// Close the lexurgy process and drop any cached results.
 void Close();
+
+/// Profile sound changes.
+///
+/// This applies each rule on its own to the output of the previous one
+/// and measures how long each of them takes. The results are never
+/// cached. Like Apply(), this does not block, and the request can be
+/// cancelled with Cancel().
+auto Profile(
+    QStringView words,
+    QString changes,
+    std::vector<QString> rules,
+    ProfileCallback cb
+) -> Result<RequestId>;
+
+/// Start Lexurgy in the background and prepare it for the given sound
+/// changes by loading them and applying them to a few of the words.
+///
+/// Applying sound changes for the first time after Lexurgy has been
+/// started is very slow since the JVM needs to warm up first; this is
+/// meant to get that out of the way before the user asks for anything.
+/// The callback is invoked once every server is ready.
+auto Prewarm(QStringView words, QString changes, Callback cb) -> Result<RequestId>;
+
+/// Load cached results from a file. Does nothing if the file
+/// doesn’t exist.
+auto LoadCache(const QString& path) -> Result<>;
+
+/// Enable or disable caching results. This is enabled by default;
+/// disable it if every word is only ever going to be seen once, e.g.
+/// when streaming a huge file through Lexurgy. Disabling the cache also
+/// drops everything in it.
+void SetCacheEnabled(bool enabled);
+
+/// Get why the native engine was not used for the most recent request
+/// even though it was enabled, e.g. because it doesn’t support the sound
+/// changes. Returns nothing if it was used or is disabled.
+auto NativeEngineFallbackReason() -> std::optional<std::string>;
+
+/// Set when to use the native engine instead of Lexurgy, overriding
+/// the user’s setting.
+void SetNativeEngineMode(NativeEngineMode mode);
+
+/// Use a fixed number of server processes instead of the number
+/// specified in the user’s settings.
+void SetServerCount(usz count);
+
+/// Save cached results to a file so they can be reused the next
+/// time the project is opened.
+auto SaveCache(const QString& path) -> Result<>;
 } // namespace smyth::lexurgy
 
 
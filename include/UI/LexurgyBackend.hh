@@ -0,0 +1,59 @@
+#ifndef SMYTH_UI_LEXURGY_BACKEND_HH
+#define SMYTH_UI_LEXURGY_BACKEND_HH
+
+#include <memory>
+#include <span>
+#include <UI/Lexurgy.hh>
+
+namespace smyth::lexurgy::detail {
+/// Something that applies sound changes for the connexion.
+///
+/// This is usually a Lexurgy process that we talk to over a pipe, but
+/// if Smyth is built with SMYTH_LEXURGY_JNI, it can also be Lexurgy
+/// running in a JVM inside Smyth. Either way, requests are processed
+/// in order, and callbacks are invoked on the GUI thread.
+class Backend {
+    LIBBASE_IMMOVABLE(Backend);
+
+protected:
+    Backend() = default;
+
+public:
+    virtual ~Backend() = default;
+
+    /// Queue a request to apply sound changes to a number of words.
+    virtual void Apply(
+        RequestId id,
+        QString changes,
+        std::span<const QStringView> words,
+        QStringView start_at,
+        QStringView stop_before,
+        Callback cb
+    ) = 0;
+
+    /// Cancel a request.
+    virtual void Cancel(RequestId id) = 0;
+
+    /// Shut down the backend and drop all pending requests.
+    virtual void Close() = 0;
+
+    /// Check whether this backend has nothing to do.
+    virtual bool Idle() const = 0;
+
+    /// Check whether this runs Lexurgy inside Smyth.
+    virtual bool InProcess() const = 0;
+
+    /// Check whether the backend is still usable.
+    virtual bool Running() const = 0;
+
+    /// Start the backend.
+    virtual auto Start() -> Result<> = 0;
+};
+
+#ifdef SMYTH_LEXURGY_JNI
+/// Create a backend that runs Lexurgy in a JVM inside Smyth.
+auto CreateInProcessBackend() -> std::unique_ptr<Backend>;
+#endif
+} // namespace smyth::lexurgy::detail
+
+#endif // SMYTH_UI_LEXURGY_BACKEND_HH
@@ -0,0 +1,88 @@
+#ifndef SMYTH_UI_LEXURGY_PROTOCOL_HH
+#define SMYTH_UI_LEXURGY_PROTOCOL_HH
+
+#include <deque>
+#include <optional>
+#include <QByteArrayView>
+#include <QString>
+#include <Smyth/JSON.hh>
+#include <span>
+#include <string>
+
+/// Encoding requests to and decoding responses from the Lexurgy server.
+namespace smyth::lexurgy::detail {
+/// Incremental reader for Lexurgy’s responses.
+///
+/// Every response is a single line of JSON, but large ones arrive across
+/// many reads from the pipe. Instead of accumulating the entire line and
+/// then parsing it into a DOM, we scan the data as it comes in: each word
+/// in the top-level ‘words’ array is decoded and appended to the output as
+/// soon as it is complete, after which the bytes it occupied are dropped.
+/// Everything else in the response is small and is kept in a ‘skeleton’
+/// (the response minus the words) that is parsed once the line is done.
+class ResponseReader {
+public:
+    struct Response {
+        /// Everything but the words.
+        json_utils::json header;
+
+        /// The words, each terminated by a newline.
+        QString words;
+    };
+
+private:
+    /// Responses that have been read in full.
+    std::deque<Result<Response>> complete;
+
+    /// The response we’re currently reading.
+    std::string skeleton;
+    QString words;
+
+    /// The word or top-level key we’re currently reading; this is
+    /// the raw JSON string, without the quotes.
+    std::string str;
+
+    /// Parser state.
+    int depth = 0;
+    bool in_string = false;
+    bool escape = false;
+    bool expect_key = false;
+    bool in_words = false;
+    bool discard = false;
+
+public:
+    /// Process data read from the pipe.
+    void feed(QByteArrayView data);
+
+    /// Discard any partial response.
+    void reset();
+
+    /// Get the next complete response, if there is one.
+    auto take() -> std::optional<Result<Response>>;
+
+private:
+    /// Append a decoded JSON string to the output.
+    static auto AppendDecoded(QString& out, std::string_view raw) -> Result<>;
+
+    /// Finish the current response.
+    void Finish();
+};
+
+/// Append a string to a JSON message, quoted and escaped.
+///
+/// This goes straight from UTF-16 to UTF-8 without converting the string
+/// to a std::string first; unpaired surrogates are replaced with U+FFFD.
+void AppendJsonString(std::string& out, QStringView str);
+
+/// Build an ‘apply’ request.
+auto EncodeApply(
+    std::span<const QStringView> words,
+    QStringView start_at = {},
+    QStringView stop_before = {}
+) -> std::string;
+
+/// Build a ‘load_string’ request.
+auto EncodeLoadChanges(QStringView changes) -> std::string;
+} // namespace smyth::lexurgy::detail
+
+#endif // SMYTH_UI_LEXURGY_PROTOCOL_HH
@@ -1,8 +1,15 @@
 #ifndef SMYTH_UI_MAINWINDOW_HH
 #define SMYTH_UI_MAINWINDOW_HH
 
+#include <QLabel>
 #include <QMainWindow>
 #include <QStringListModel>
+#include <QTimer>
+#include <Smyth/Trace.hh>
+#include <Smyth/WordGenerator.hh>
+#include <UI/JSInterpolator.hh>
+#include <UI/Lexurgy.hh>
+#include <UI/RuleOutline.hh>
 #include <UI/Smyth.hh>
 #include <UI/SmythPlainTextEdit.hh>
 
@@ -26,6 +33,37 @@ class MainWindow final : public QMainWindow {
 
     QMenu* notes_tab_context_menu;
 
+    /// The apply request we’re currently waiting for, if any.
+    lexurgy::RequestId pending_apply = 0;
+
+    /// How long to wait after the last edit before applying sound
+    /// changes in live mode.
+    static constexpr int LiveApplyDelay = 300;
+
+    /// Timer used to debounce live mode.
+    QTimer* live_apply_timer;
+
+    /// The prewarm request we’re currently waiting for, if any.
+    lexurgy::RequestId pending_prewarm = 0;
+
+    /// The profiling request we’re currently waiting for, if any.
+    lexurgy::RequestId pending_profile = 0;
+
+    /// Index of the rules in the sound changes.
+    RuleOutline* outline;
+
+    /// Engine used to evaluate JavaScript in the sound changes.
+    JSInterpolator js;
+
+    /// Status bar label that shows whether Lexurgy is starting up.
+    QLabel* lexurgy_status;
+
+    /// Status bar label that shows how long the last apply took.
+    QLabel* timing_status;
+
+    /// Distribution of class members in the last generated words.
+    std::vector<wordgen::Generator::Frequency> wordgen_frequencies;
+
     MainWindow();
 
 public:
@@ -34,6 +72,10 @@ public:
     /// Get the text box used by the notes tab.
     static auto GetNotesTabTextBox() -> SmythPlainTextEdit*;
 
+    /// Stop waiting for any requests to Lexurgy, e.g. because a different
+    /// project was opened and their results are no longer relevant.
+    static void CancelPendingRequests();
+
     /// Prompt the user.
     static auto Prompt(
         const QString& title,
@@ -41,9 +83,17 @@ public:
         QMessageBox::StandardButtons buttons = QMessageBox::Yes | QMessageBox::No
     ) -> QMessageBox::StandardButton;
 
+    /// Start Lexurgy in the background and load the current sound changes
+    /// so the first time the user applies them doesn’t take ages.
+    static void PrewarmLexurgy();
+
     /// Reset the window to its default settings.
     static void Reset();
 
+    /// Discard all JavaScript state, e.g. because a different project
+    /// was opened.
+    static void ResetJavaScript();
+
     /// Set the path to be shown in the window title. If the
     /// path is empty, it is set to 'Smyth' instead.
     static void SetWindowPath(QString path = "");
@@ -60,21 +110,38 @@ public:
 
 public slots:
     void apply_sound_changes();
+    void apply_sound_changes_live();
     void char_map_update_selection(char32_t c);
+    void count_words();
+    void export_timing_trace();
     void generate_words();
+    void goto_rule(int index);
     void new_project();
     void open_project();
     void open_settings();
     void preview_changes_after_eval();
+    void profile_sound_changes();
     void prompt_quit();
     void save_project();
+    void schedule_live_apply();
     void show_project_directory();
+    void show_wordgen_distribution();
+    void update_rule_names();
+    void update_wordgen_dedup_columns();
 
 private:
-    auto ApplySoundChanges() -> Result<>;
+    auto ApplySoundChanges(bool live = false) -> Result<>;
+    auto CountWords() -> Result<>;
     auto EvaluateAndInterpolateJavaScript(QString& in_string) -> Result<>;
+    auto GenerateWords() -> Result<>;
+    auto GetRuleNames(const QString& changes) -> QStringList;
+    auto GetSoundChanges() -> Result<QString>;
     void Init();
     void Persist();
+    auto ProfileSoundChanges() -> Result<>;
+    void ShowTiming(const trace::Breakdown& b);
+    void SetRuleNames(const QStringList& names);
+    void UpdateWordgenDedupColumns();
 };
 } // namespace smyth::ui
 #endif // SMYTH_UI_MAINWINDOW_HH
@@ -6,6 +6,7 @@
 #include <QFont>
 #include <QSize>
 #include <QString>
+#include <Smyth/ChunkedText.hh>
 #include <Smyth/Persistent.hh>
 
 namespace smyth::ui {
@@ -38,6 +39,7 @@ struct smyth::detail::Serialiser<QList<Int>> {
 };
 
 SMYTH_DECLARE_SERIALISER(const QByteArray&, QByteArray);
+SMYTH_DECLARE_SERIALISER(const ChunkedText&, ChunkedText);
 SMYTH_DECLARE_SERIALISER(const QFont&, QFont);
 SMYTH_DECLARE_SERIALISER(QSize, QSize);
 SMYTH_DECLARE_SERIALISER(const QString&, QString);
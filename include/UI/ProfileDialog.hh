@@ -0,0 +1,36 @@
+#ifndef SMYTH_UI_PROFILEDIALOG_HH
+#define SMYTH_UI_PROFILEDIALOG_HH
+
+#include <QDialog>
+#include <UI/Lexurgy.hh>
+#include <UI/Smyth.hh>
+
+QT_BEGIN_NAMESPACE
+namespace Ui {
+class ProfileDialog;
+}
+QT_END_NAMESPACE
+
+namespace smyth::ui {
+class ProfileDialog;
+} // namespace smyth::ui
+
+class smyth::ui::ProfileDialog final : public QDialog {
+    Q_OBJECT
+
+    std::unique_ptr<Ui::ProfileDialog> ui;
+
+public:
+    LIBBASE_IMMOVABLE(ProfileDialog);
+    ProfileDialog(QWidget* parent);
+    ~ProfileDialog() noexcept;
+
+    /// Show how long each rule took to apply.
+    static void Show(
+        std::span<const lexurgy::RuleProfile> results,
+        usz words,
+        QWidget* parent = nullptr
+    );
+};
+
+#endif // SMYTH_UI_PROFILEDIALOG_HH
@@ -0,0 +1,100 @@
+#ifndef SMYTH_UI_RULEOUTLINE_HH
+#define SMYTH_UI_RULEOUTLINE_HH
+
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QTextDocument>
+#include <Smyth/Utils.hh>
+
+namespace smyth::ui {
+class RuleOutline;
+} // namespace smyth::ui
+
+/// Index of the rules in a sound changes document.
+///
+/// Rather than reparsing the entire document whenever we need to know
+/// what rules there are, we only reparse the lines that are edited and
+/// remember which of them start a rule. Everything else is computed from
+/// that on demand.
+class smyth::ui::RuleOutline final : public QObject {
+    Q_OBJECT
+    LIBBASE_IMMOVABLE(RuleOutline);
+
+    class BlockData;
+    friend BlockData;
+
+public:
+    struct Rule {
+        /// The name of the rule.
+        QString name;
+
+        /// The line that the rule starts on, starting at 0.
+        int line;
+
+        /// The position of the start of the rule in the document.
+        int begin;
+
+        /// The position of the end of the rule, i.e. the start of the next
+        /// rule, or the end of the document if this is the last rule.
+        int end;
+
+        /// Whether this is a special rule (e.g. the romaniser) that we
+        /// can’t start at or stop before.
+        bool special;
+    };
+
+private:
+    QPointer<QTextDocument> document;
+
+    /// The rules, in order; only valid if ‘positions_changed’ is false.
+    std::vector<Rule> cached_rules;
+
+    /// The names of all rules, in order.
+    QStringList cached_all_names;
+
+    /// The names of all rules that aren’t special, in order.
+    QStringList cached_names;
+
+    /// Whether any rules were added, removed, or renamed.
+    bool structure_changed = false;
+
+    /// Whether anything in the document was changed at all.
+    bool positions_changed = true;
+
+public:
+    explicit RuleOutline(QTextDocument* document, QObject* parent = nullptr);
+    ~RuleOutline() noexcept override;
+
+    /// Find a rule by name.
+    auto find(QStringView name) -> const Rule*;
+
+    /// Get the names of all rules that aren’t special.
+    auto names() const -> const QStringList& { return cached_names; }
+
+    /// Get all rules.
+    auto rules() -> std::span<const Rule>;
+
+    /// Check whether a rule name is special.
+    static bool IsSpecial(QStringView name);
+
+    /// Get the names of all rules in a piece of text that isn’t part of
+    /// a document; this has to parse the entire text.
+    static auto Parse(QStringView text) -> QStringList;
+
+    /// Check if a line starts a rule, and return its name if so.
+    static auto ParseRuleName(QStringView line) -> std::optional<QStringView>;
+
+signals:
+    /// A rule was added, removed, or renamed.
+    void namesChanged();
+
+private:
+    /// Rebuild the list of rule names.
+    void RebuildNames();
+
+    /// Update the index after the document has changed.
+    void Update(int position, int removed, int added);
+};
+
+#endif // SMYTH_UI_RULEOUTLINE_HH
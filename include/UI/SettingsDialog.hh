@@ -35,14 +35,20 @@ public:
     /// Get the rows in the dictionary we should duplicate.
     static auto GetRowsToDuplicate() -> Result<QList<int>>;
 
+    /// Check whether we should save Lexurgy’s results with the project.
+    static bool SaveLexurgyCache();
+
     /// Reset the settings dialog as appropriate for a new project. This
     /// must be called after the main window has been initialised.
     static void Reset();
 
 public slots:
     void set_default_font();
+    void set_lexurgy_servers(int count);
     void set_mono_font();
     void set_notes_font();
+    void toggle_lexurgy_in_process();
+    void toggle_native_engine();
     void toggle_show_json_requests();
 
 private:
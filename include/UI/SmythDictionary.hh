@@ -92,6 +92,12 @@ public:
     SmythDictionary(QWidget* parent = nullptr);
     ~SmythDictionary() override;
 
+    /// Get the contents of all cells in a column.
+    auto column_contents(int col) const -> QStringList;
+
+    /// Get the name of each column.
+    auto column_names() const -> QStringList;
+
     void contextMenuEvent(QContextMenuEvent* event) override;
     void keyPressEvent(QKeyEvent* event) override;
     void persist(PersistentStore& store);
@@ -0,0 +1,86 @@
+#ifndef SMYTH_UI_SMYTH_OUTPUT_VIEW_HH
+#define SMYTH_UI_SMYTH_OUTPUT_VIEW_HH
+
+#include <QAbstractListModel>
+#include <QListView>
+#include <UI/Mixins.hh>
+#include <UI/Smyth.hh>
+
+namespace smyth::ui {
+class SmythOutputView;
+}
+
+/// Read-only view of the output of the sound changes.
+///
+/// Every line is an item in a list model, and the view only lays out the
+/// lines that are visible, so this stays fast even for huge outputs. When
+/// new output is set, only lines that actually changed are updated, which
+/// preserves the scroll position and selection, and those lines are
+/// highlighted until the next time the output changes.
+class smyth::ui::SmythOutputView final : public QListView
+    , mixins::Zoom {
+    Q_OBJECT
+
+    friend Zoom;
+
+    using This = SmythOutputView;
+
+    class Model final : public QAbstractListModel {
+        QStringList lines;
+
+        /// Which lines changed in the last update.
+        std::vector<bool> changed;
+
+    public:
+        QColor highlight;
+
+        auto data(const QModelIndex& index, int role) const -> QVariant override;
+        auto rowCount(const QModelIndex& parent = {}) const -> int override;
+
+        /// Replace the contents without highlighting anything.
+        void reset(QStringList new_lines);
+
+        /// Diff against the current contents and update whatever changed.
+        void update(QStringList new_lines);
+
+        /// Get all lines.
+        auto text() const -> const QStringList& { return lines; }
+    };
+
+    Model model;
+
+public:
+    SmythOutputView(QWidget* parent = nullptr);
+
+    /// Copy the selected lines to the clipboard.
+    void copy();
+
+    void keyPressEvent(QKeyEvent* event) override;
+
+    void persist(PersistentStore& store, std::string_view key) {
+        Persist<&This::toPlainText, &This::setPlainText>(
+            store,
+            std::format("{}.text", key),
+            this
+        );
+    }
+
+    /// Replace the output entirely, e.g. when loading a project.
+    void setPlainText(const QString& text);
+
+    /// Get the output as text.
+    auto toPlainText() const -> QString;
+
+    /// Update the output with the result of applying sound changes.
+    void updateText(const QString& text);
+
+    void wheelEvent(QWheelEvent* event) override {
+        if (HandleZoomEvent(event)) return;
+        QListView::wheelEvent(event);
+    }
+
+protected:
+    void changeEvent(QEvent* event) override;
+};
+
+#endif // SMYTH_UI_SMYTH_OUTPUT_VIEW_HH
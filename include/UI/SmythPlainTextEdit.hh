@@ -1,7 +1,9 @@
 #ifndef SMYTH_UI_SMYTHPLAINTEXTEDIT_HH
 #define SMYTH_UI_SMYTHPLAINTEXTEDIT_HH
 
+#include <optional>
 #include <QPlainTextEdit>
+#include <Smyth/ChunkedText.hh>
 #include <UI/Smyth.hh>
 #include <UI/Mixins.hh>
 
@@ -17,18 +19,62 @@ class smyth::ui::SmythPlainTextEdit final : public QPlainTextEdit
 
     using This = SmythPlainTextEdit;
 
+    /// Texts at least this long (in UTF-16 code units) are not loaded into
+    /// the editor if large-document mode is enabled.
+    static constexpr qsizetype LargeDocumentThreshold = 4 << 20;
+
+    /// How many lines to show while in large-document mode.
+    static constexpr qsizetype LargeDocumentPreviewLines = 1'000;
+
+    /// The text, if we’re in large-document mode.
+    std::optional<ChunkedText> large;
+
+    /// Whether large-document mode may be used at all.
+    bool large_documents_enabled = false;
+
+    /// Whether this was read-only before we entered large-document mode.
+    bool was_read_only = false;
+
 public:
     SmythPlainTextEdit(QWidget* parent = nullptr)
         : QPlainTextEdit(parent) {}
 
+    /// Allow switching to large-document mode.
+    ///
+    /// In large-document mode, the text is kept in a separate store, and
+    /// only the first few lines are shown, read-only; this is entered
+    /// automatically when a huge text is set, pasted, or loaded from a file.
+    void enableLargeDocumentMode() { large_documents_enabled = true; }
+
+    /// Get the text as chunks that each end at a line break, except for
+    /// the last one. Unlike text(), this doesn’t copy anything.
+    auto chunks() const -> QList<QString>;
+
+    /// Whether we’re currently in large-document mode.
+    auto isLargeDocument() const -> bool { return large.has_value(); }
+
+    /// Replace the text with the contents of a file.
+    auto loadFile(const QString& path) -> Result<>;
+
     void persist(PersistentStore& store, std::string_view key) {
-        Persist<&This::toPlainText, &This::setPlainText>(
+        Persist<&This::snapshot, &This::setSnapshot>(
             store,
             std::format("{}.text", key),
             this
         );
     }
 
+    /// Set the text, switching to large-document mode if it is huge.
+    void setSnapshot(ChunkedText text);
+    void setText(const QString& text);
+
+    /// Get the text without copying it in large-document mode.
+    auto snapshot() const -> ChunkedText;
+
+    /// Get the text; use this instead of toPlainText(), which only
+    /// returns the preview in large-document mode.
+    auto text() const -> QString;
+
     void wheelEvent(QWheelEvent* event) override {
         if (HandleZoomEvent(event)) return;
         QPlainTextEdit::wheelEvent(event);
@@ -46,6 +92,21 @@ public:
 
         QPlainTextEdit::keyPressEvent(event);
     }
+
+public slots:
+    /// Load the full text into the editor so it can be edited.
+    void edit_full_text();
+
+    /// Prompt the user for a file to load.
+    void load_file();
+
+protected:
+    void contextMenuEvent(QContextMenuEvent* event) override;
+    void insertFromMimeData(const QMimeData* source) override;
+
+private:
+    void EnterLargeDocumentMode(ChunkedText text);
+    void LeaveLargeDocumentMode();
 };
 
 #endif // SMYTH_UI_SMYTHPLAINTEXTEDIT_HH
@@ -0,0 +1,85 @@
+#ifndef SMYTH_UI_SMYTH_WORD_LIST_HH
+#define SMYTH_UI_SMYTH_WORD_LIST_HH
+
+#include <QAbstractListModel>
+#include <QListView>
+#include <UI/Mixins.hh>
+#include <UI/Smyth.hh>
+
+namespace smyth::ui {
+class SmythWordList;
+}
+
+/// Read-only view of a long list of words, e.g. the output of the word
+/// generator.
+///
+/// All words are stored in a single string, and the view only lays out
+/// the words that are visible, so setting even millions of words is
+/// cheap. At most MaxWords words are kept; anything beyond that is
+/// dropped.
+class smyth::ui::SmythWordList final : public QListView
+    , mixins::Zoom {
+    Q_OBJECT
+
+    friend Zoom;
+
+    using This = SmythWordList;
+
+public:
+    /// Maximum number of words to keep.
+    static constexpr usz MaxWords = 10'000'000;
+
+private:
+    class Model final : public QAbstractListModel {
+        /// The words, each terminated by a newline.
+        QString words;
+
+        /// Offset of the start of each word in the string, plus the end
+        /// of the last word.
+        std::vector<qsizetype> starts{0};
+
+    public:
+        auto data(const QModelIndex& index, int role) const -> QVariant override;
+        auto rowCount(const QModelIndex& parent = {}) const -> int override;
+
+        /// Replace the contents.
+        void reset(const QString& text);
+
+        /// Get a word.
+        auto word(usz index) const -> QStringView;
+
+        /// Get all words.
+        auto text() const -> const QString& { return words; }
+    };
+
+    Model model;
+
+public:
+    SmythWordList(QWidget* parent = nullptr);
+
+    /// Copy the selected words to the clipboard.
+    void copy();
+
+    void keyPressEvent(QKeyEvent* event) override;
+
+    void persist(PersistentStore& store, std::string_view key) {
+        Persist<&This::toPlainText, &This::setPlainText>(
+            store,
+            std::format("{}.text", key),
+            this
+        );
+    }
+
+    /// Set the words, one per line.
+    void setPlainText(const QString& text);
+
+    /// Get the words, one per line.
+    auto toPlainText() const -> QString { return model.text(); }
+
+    void wheelEvent(QWheelEvent* event) override {
+        if (HandleZoomEvent(event)) return;
+        QListView::wheelEvent(event);
+    }
+};
+
+#endif // SMYTH_UI_SMYTH_WORD_LIST_HH
@@ -20,6 +20,12 @@ class smyth::ui::TextPreviewDialog final : public QDialog {
     std::unique_ptr<Ui::TextPreviewDialog> ui;
 
 public:
+    /// Additional information to show below the text.
+    struct Table {
+        QStringList headers;
+        QList<QStringList> rows;
+    };
+
     LIBBASE_IMMOVABLE(TextPreviewDialog);
     TextPreviewDialog(QWidget* parent);
     ~TextPreviewDialog() noexcept;
@@ -28,7 +34,8 @@ public:
         const QString& title,
         const QString& text,
         const QFont& font,
-        QWidget* parent = nullptr
+        QWidget* parent = nullptr,
+        const Table& table = {}
     );
 
 public slots:
@@ -94,6 +94,12 @@ extern UserSetting<QFont> MonoFont;
 extern UserSetting<QFont> SerifFont;
 extern UserSetting<QFont> SansFont;
 extern UserSetting<> LastOpenProject;
+extern UserSetting<int> LexurgyServers;
+extern UserSetting<bool> NativeEngine;
+
+#ifdef SMYTH_LEXURGY_JNI
+extern UserSetting<bool> LexurgyInProcess;
+#endif
 
 #ifdef LIBBASE_DEBUG
 extern UserSetting<bool> DumpJsonRequests;
@@ -0,0 +1,276 @@
+#include <base/Text.hh>
+#include <deque>
+#include <print>
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QFile>
+#include <Smyth/JSON.hh>
+#include <Smyth/Unicode.hh>
+#include <UI/Batch.hh>
+#include <UI/JSInterpolator.hh>
+#include <UI/Lexurgy.hh>
+#include <UI/RuleOutline.hh>
+#include <UI/Smyth.hh>
+#include <UI/UserSettings.hh>
+
+using namespace smyth;
+using namespace smyth::ui;
+using json = json_utils::json;
+
+namespace {
+/// Number of words to send to Lexurgy at once by default.
+constexpr qsizetype DefaultBatchSize = 50'000;
+
+/// Maximum number of batches to keep in flight at once; this is so we can
+/// read and normalise the next batch while Lexurgy is busy.
+constexpr usz MaxBatchesInFlight = 2;
+
+/// Everything we need to know to apply sound changes.
+struct Config {
+    QString changes;
+    QString start_at;
+    QString stop_before;
+    text::NormalisationForm input_norm = text::NormalisationForm::None;
+    text::NormalisationForm changes_norm = text::NormalisationForm::None;
+    text::NormalisationForm output_norm = text::NormalisationForm::None;
+    bool javascript = false;
+};
+
+/// A batch of words that is being processed by Lexurgy.
+struct Batch {
+    std::optional<Result<QString>> result;
+};
+
+/// Convert the index of a normalisation combo box in the GUI.
+auto NormFromIndex(i64 index) -> text::NormalisationForm {
+    switch (index) {
+        default: return text::NormalisationForm::None;
+        case 1: return text::NormalisationForm::NFC;
+        case 2: return text::NormalisationForm::NFD;
+    }
+}
+
+/// Parse a normalisation form given on the command line.
+auto ParseNorm(const QString& str) -> Result<text::NormalisationForm> {
+    auto s = str.toLower();
+    if (s == "none") return text::NormalisationForm::None;
+    if (s == "nfc") return text::NormalisationForm::NFC;
+    if (s == "nfd") return text::NormalisationForm::NFD;
+    return Error("Invalid normalisation form '{}'; expected 'none', 'nfc', or 'nfd'", str);
+}
+
+/// Read everything in a file.
+auto ReadFile(const QString& path) -> Result<QString> {
+    QFile f{path};
+    if (not f.open(QIODevice::ReadOnly)) return Error("Could not open file '{}'", path);
+    return QString::fromUtf8(f.readAll());
+}
+
+/// Load the sound changes and SCA settings from a project.
+///
+/// We don’t go through the persistence API here since that requires all
+/// the widgets to exist; instead, we only read the entries we care about
+/// and use the same defaults as the GUI for anything that’s missing.
+auto LoadProject(const QString& path, Config& c) -> Result<> {
+    auto text = Try(ReadFile(path));
+    auto j = Try(json_utils::Parse(text.toStdString()));
+    auto v = j.contains("version") and j["version"].is_number_unsigned() ? j["version"].get<u64>() : 0;
+    if (v != SMYTH_CURRENT_CONFIG_FILE_VERSION) return Error(
+        "Project '{}' was created with a different version of Smyth ({} vs expected {})",
+        path,
+        v,
+        SMYTH_CURRENT_CONFIG_FILE_VERSION
+    );
+
+    if (not j.contains("main") or not j["main"].is_object()) return Error("Project '{}' is empty", path);
+    auto& main = j["main"];
+    if (main.contains("changes.text")) {
+        const std::string& changes = Try(json_utils::Get<std::string>(main["changes.text"]));
+        c.changes = QString::fromStdString(changes);
+    }
+
+    if (not main.contains("sca") or not main["sca"].is_object()) return {};
+    auto& sca = main["sca"];
+    auto Int = [&](const char* key, i64 def) -> Result<i64> {
+        if (not sca.contains(key)) return def;
+        return json_utils::Get<i64>(sca[key]);
+    };
+
+    auto String = [&](const char* key) -> Result<QString> {
+        if (not sca.contains(key)) return QString{};
+        const std::string& s = Try(json_utils::Get<std::string>(sca[key]));
+        return QString::fromStdString(s);
+    };
+
+    // These defaults match what is set in the UI file.
+    c.input_norm = NormFromIndex(Try(Int("cbox.input.norm.choice", 1)));
+    c.changes_norm = NormFromIndex(Try(Int("cbox.changes.norm.choice", 1)));
+    c.output_norm = NormFromIndex(Try(Int("cbox.output.norm.choice", 1)));
+    c.start_at = Try(String("cbox.start.after"));
+    c.stop_before = Try(String("cbox.stop.before"));
+    c.javascript = Try(Int("chbox.enable.js", Qt::Unchecked)) == Qt::Checked;
+    return {};
+}
+
+/// Read up to ‘count’ lines.
+auto ReadLines(QFile& in, qsizetype count) -> QString {
+    QString words;
+    for (qsizetype i = 0; i < count and not in.atEnd(); i++) {
+        auto line = in.readLine();
+        if (line.endsWith('\n')) line.chop(1);
+        if (line.endsWith('\r')) line.chop(1);
+        words += QUtf8StringView{line.constData(), line.size()};
+        words += '\n';
+    }
+    return words;
+}
+
+auto Run(const QStringList& args) -> Result<> {
+    // We don’t create any widgets, but we still want to respect e.g. the
+    // number of Lexurgy servers the user has configured.
+    detail::user_settings::Init();
+
+    QCommandLineParser p;
+    p.setApplicationDescription(
+        "Apply sound changes to words read from a file or stdin, one per line,\n"
+        "and write the results to stdout."
+    );
+    p.addHelpOption();
+    p.addPositionalArgument("source", "A Smyth project (.smyth) or a Lexurgy sound changes file.");
+    p.addPositionalArgument("input", "File to read words from. Defaults to stdin.", "[input]");
+    QCommandLineOption output{{"o", "output"}, "Write output to <file> instead of stdout.", "file"};
+    QCommandLineOption start_at{"start-at", "Start at <rule>.", "rule"};
+    QCommandLineOption stop_before{"stop-before", "Stop before <rule>.", "rule"};
+    QCommandLineOption input_norm{"input-norm", "Normalise input to <form> (none, nfc, nfd).", "form"};
+    QCommandLineOption changes_norm{"changes-norm", "Normalise sound changes to <form>.", "form"};
+    QCommandLineOption output_norm{"output-norm", "Normalise output to <form>.", "form"};
+    QCommandLineOption javascript{"js", "Evaluate JavaScript in the sound changes."};
+    QCommandLineOption no_javascript{"no-js", "Don’t evaluate JavaScript in the sound changes."};
+    QCommandLineOption servers{"servers", "Number of Lexurgy processes to run.", "count"};
+    QCommandLineOption batch_size{"batch-size", "Number of words to send to Lexurgy at once.", "count"};
+    QCommandLineOption native{"native", "Use the native engine if possible (on), never (off), or compare it against Lexurgy (check).", "mode"};
+    p.addOptions({output, start_at, stop_before, input_norm, changes_norm, output_norm, javascript, no_javascript, servers, batch_size, native});
+    p.process(args);
+
+    auto positional = p.positionalArguments();
+    if (positional.empty() or positional.size() > 2) {
+        p.showHelp(1);
+        return {};
+    }
+
+    // Load the project or sound changes; options given on the command
+    // line override whatever is set in the project.
+    Config c;
+    auto& source = positional[0];
+    if (source.endsWith(".smyth")) Try(LoadProject(source, c));
+    else c.changes = Try(ReadFile(source));
+    if (p.isSet(start_at)) c.start_at = p.value(start_at);
+    if (p.isSet(stop_before)) c.stop_before = p.value(stop_before);
+    if (p.isSet(input_norm)) c.input_norm = Try(ParseNorm(p.value(input_norm)));
+    if (p.isSet(changes_norm)) c.changes_norm = Try(ParseNorm(p.value(changes_norm)));
+    if (p.isSet(output_norm)) c.output_norm = Try(ParseNorm(p.value(output_norm)));
+    if (p.isSet(javascript)) c.javascript = true;
+    if (p.isSet(no_javascript)) c.javascript = false;
+    if (p.isSet(servers)) {
+        bool ok = false;
+        auto n = p.value(servers).toInt(&ok);
+        if (not ok or n < 1) return Error("Invalid server count '{}'", p.value(servers));
+        lexurgy::SetServerCount(usz(n));
+    }
+
+    // Every batch contains different words, so caching them would only
+    // use up memory and time.
+    lexurgy::SetCacheEnabled(false);
+
+    if (p.isSet(native)) {
+        auto mode = p.value(native).toLower();
+        if (mode == "on") lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Enabled);
+        else if (mode == "off") lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Disabled);
+        else if (mode == "check") lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Differential);
+        else return Error("Invalid native engine mode '{}'; expected 'on', 'off', or 'check'", p.value(native));
+    }
+
+    auto words_per_batch = DefaultBatchSize;
+    if (p.isSet(batch_size)) {
+        bool ok = false;
+        words_per_batch = p.value(batch_size).toLongLong(&ok);
+        if (not ok or words_per_batch < 1) return Error("Invalid batch size '{}'", p.value(batch_size));
+    }
+
+    // Prepare the sound changes the same way the GUI does.
+    Try(Normalise(c.changes, c.changes_norm));
+    if (c.javascript) {
+        JSInterpolator js;
+        Try(js.interpolate(c.changes));
+    }
+
+    auto rules = RuleOutline::Parse(c.changes);
+    if (not c.start_at.isEmpty() and not rules.contains(c.start_at)) return Error("No rule named '{}'", c.start_at);
+    if (not c.stop_before.isEmpty() and not rules.contains(c.stop_before)) return Error("No rule named '{}'", c.stop_before);
+
+    // Open input and output.
+    QFile in, out;
+    if (positional.size() == 2) {
+        in.setFileName(positional[1]);
+        if (not in.open(QIODevice::ReadOnly)) return Error("Could not open input file '{}'", positional[1]);
+    } else if (not in.open(stdin, QIODevice::ReadOnly)) {
+        return Error("Could not read from stdin");
+    }
+
+    if (p.isSet(output)) {
+        out.setFileName(p.value(output));
+        if (not out.open(QIODevice::WriteOnly | QIODevice::Truncate)) return Error("Could not open output file '{}'", p.value(output));
+    } else if (not out.open(stdout, QIODevice::WriteOnly)) {
+        return Error("Could not write to stdout");
+    }
+
+    // Stream the words through Lexurgy in batches, keeping a few of them
+    // in flight so Lexurgy never has to wait for us.
+    QEventLoop loop;
+    std::deque<std::shared_ptr<Batch>> in_flight;
+    std::optional<std::string> native_fallback;
+    auto Submit = [&] -> Result<bool> {
+        auto words = ReadLines(in, words_per_batch);
+        if (words.isEmpty()) return false;
+        Try(Normalise(words, c.input_norm));
+        auto batch = std::make_shared<Batch>();
+        Try(lexurgy::Apply(words, c.changes, c.start_at, c.stop_before, [batch, &loop](Result<QString> res) {
+            batch->result = std::move(res);
+            loop.quit();
+        }));
+        if (not native_fallback) native_fallback = lexurgy::NativeEngineFallbackReason();
+        in_flight.push_back(std::move(batch));
+        return true;
+    };
+
+    for (bool eof = false;;) {
+        while (not eof and in_flight.size() < MaxBatchesInFlight) eof = not Try(Submit());
+        if (in_flight.empty()) break;
+
+        auto batch = std::move(in_flight.front());
+        in_flight.pop_front();
+        while (not batch->result) loop.exec();
+
+        auto text = Try(std::move(*batch->result));
+        Try(Normalise(text, c.output_norm));
+        if (out.write(text.toUtf8()) == -1) return Error("Failed to write output: {}", out.errorString());
+    }
+
+    out.flush();
+    lexurgy::Close();
+
+    // Let the user know if they asked for the native engine but didn’t
+    // get it; this is especially important when comparing it against
+    // Lexurgy, since there is nothing to compare in that case.
+    if (p.isSet(native) and native_fallback)
+        std::println(stderr, "Note: Native engine not used: {}", *native_fallback);
+    return {};
+}
+} // namespace
+
+int batch::Apply(const QStringList& args) {
+    auto res = Run(args);
+    if (res) return 0;
+    std::println(stderr, "Error: {}", res.error());
+    return 1;
+}
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <numeric>
+#include <print>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QEventLoop>
+#include <QFile>
+#include <QSysInfo>
+#include <random>
+#include <Smyth/JSON.hh>
+#include <UI/Batch.hh>
+#include <UI/Lexurgy.hh>
+#include <UI/Smyth.hh>
+#include <UI/UserSettings.hh>
+
+#ifndef _WIN32
+#    include <sys/resource.h>
+#endif
+
+using namespace smyth;
+using namespace smyth::ui;
+using json = json_utils::json;
+
+namespace {
+/// Word counts to benchmark.
+constexpr std::array WordCounts{10uz, 100uz, 1'000uz, 10'000uz, 100'000uz, 1'000'000uz};
+
+/// Synthetic rulesets to benchmark, by name and number of rules.
+constexpr std::array<std::pair<std::string_view, usz>, 3> Rulesets{{
+    {"small", 3},
+    {"medium", 25},
+    {"large", 100},
+}};
+
+/// Rules that the synthetic rulesets are made of.
+constexpr std::array RuleTemplates{
+    "{p, t, k} => {b, d, g} / @vowel _ @vowel",
+    "e => i / _ $",
+    "@vowel => * / @stop _ @stop",
+    "{b, d, g} => {v, ð, ɣ} / @vowel _",
+    "s => h / $ _",
+    "{a, o} => {e, u} / _ i",
+    "n => m / _ {p, b}",
+    "h => * / _ $",
+};
+
+/// Total number of words used for each measurement when the number of
+/// iterations isn’t given explicitly; we always do at least a few so
+/// the percentiles mean something.
+constexpr usz WordsPerMeasurement = 100'000;
+constexpr usz MinIterations = 3;
+constexpr usz MaxIterations = 50;
+
+/// Words to apply sound changes to, all in one string.
+struct Words {
+    QString text;
+
+    /// Offset of the end of the first N words, by N.
+    std::vector<qsizetype> ends{0};
+
+    /// Get the first ‘count’ words.
+    auto first(usz count) const -> QStringView {
+        return QStringView{text}.first(ends[count]);
+    }
+};
+
+/// Generate a ruleset with the given number of rules.
+auto MakeRuleset(usz rules) -> QString {
+    QString s = "Class vowel {a, e, i, o, u}\nClass stop {p, t, k, b, d, g}\n";
+    for (usz i = 0; i < rules; i++) s += QString::fromStdString(std::format(
+        "\nrule-{}:\n    {}\n",
+        i,
+        RuleTemplates[i % RuleTemplates.size()]
+    ));
+    return s;
+}
+
+/// Generate random words; the seed is fixed so every run uses the
+/// same words.
+auto MakeWords(usz count) -> Words {
+    static constexpr std::string_view Consonants = "ptkbdgsnmhlr";
+    static constexpr std::string_view Vowels = "aeiou";
+    std::mt19937_64 rng{42};
+    auto Pick = [&](std::string_view s) { return QLatin1Char(s[std::uniform_int_distribution<usz>{0, s.size() - 1}(rng)]); };
+    auto Chance = std::bernoulli_distribution{0.3};
+
+    Words w;
+    w.text.reserve(qsizetype(count) * 10);
+    w.ends.reserve(count + 1);
+    for (usz i = 0; i < count; i++) {
+        auto syllables = std::uniform_int_distribution<usz>{1, 4}(rng);
+        for (usz s = 0; s < syllables; s++) {
+            w.text += Pick(Consonants);
+            w.text += Pick(Vowels);
+            if (Chance(rng)) w.text += Pick(Consonants);
+        }
+        w.text += '\n';
+        w.ends.push_back(w.text.size());
+    }
+    return w;
+}
+
+/// Apply sound changes and wait for the result.
+auto Measure(QEventLoop& loop, QStringView words, const QString& changes) -> Result<chr::nanoseconds> {
+    std::optional<Result<QString>> result;
+    auto start = chr::steady_clock::now();
+    Try(lexurgy::Apply(words, changes, "", "", [&](Result<QString> res) {
+        result = std::move(res);
+        loop.quit();
+    }));
+
+    while (not result) loop.exec();
+    auto elapsed = chr::steady_clock::now() - start;
+    Try(std::move(*result));
+    return chr::duration_cast<chr::nanoseconds>(elapsed);
+}
+
+/// Convert a duration to fractional milliseconds.
+auto Ms(chr::nanoseconds ns) -> double {
+    return chr::duration<double, std::milli>(ns).count();
+}
+
+/// Get a percentile of a sorted list of samples (nearest rank).
+auto Percentile(const std::vector<chr::nanoseconds>& sorted, double p) -> chr::nanoseconds {
+    auto rank = usz(std::ceil(p * double(sorted.size())));
+    return sorted[std::clamp(rank, 1uz, sorted.size()) - 1];
+}
+
+/// Get the peak resident set size of this process and of any Lexurgy
+/// processes that have exited, in KiB. Not supported on Windows.
+auto PeakRSS() -> json {
+#ifndef _WIN32
+    auto Get = [](int who) -> u64 {
+        rusage r{};
+        if (getrusage(who, &r) != 0) return 0;
+#    ifdef __APPLE__
+        return u64(r.ru_maxrss) / 1024; // Bytes on macOS.
+#    else
+        return u64(r.ru_maxrss);
+#    endif
+    };
+
+    return {{"self_kib", Get(RUSAGE_SELF)}, {"lexurgy_kib", Get(RUSAGE_CHILDREN)}};
+#else
+    return nullptr;
+#endif
+}
+
+auto Run(const QStringList& args) -> Result<> {
+    detail::user_settings::Init();
+
+    QCommandLineParser p;
+    p.setApplicationDescription(
+        "Benchmark applying synthetic sound changes via Lexurgy and write the\n"
+        "results as JSON to stdout. Progress is reported on stderr."
+    );
+    p.addHelpOption();
+    QCommandLineOption output{{"o", "output"}, "Write results to <file> instead of stdout.", "file"};
+    QCommandLineOption max_words{"max-words", "Skip word counts larger than <count>.", "count"};
+    QCommandLineOption iterations{"iterations", "Measure every case <count> times.", "count"};
+    QCommandLineOption servers{"servers", "Number of Lexurgy processes to run.", "count"};
+    QCommandLineOption native{"native", "Use the native engine where possible instead of always using Lexurgy."};
+    p.addOptions({output, max_words, iterations, servers, native});
+    p.process(args);
+    if (not p.positionalArguments().empty()) {
+        p.showHelp(1);
+        return {};
+    }
+
+    auto Count = [&](const QCommandLineOption& opt, std::string_view what) -> Result<usz> {
+        bool ok = false;
+        auto n = p.value(opt).toLongLong(&ok);
+        if (not ok or n < 1) return Error("Invalid {} '{}'", what, p.value(opt));
+        return usz(n);
+    };
+
+    auto max = p.isSet(max_words) ? Try(Count(max_words, "word count")) : WordCounts.back();
+    auto fixed_iterations = p.isSet(iterations) ? std::optional{Try(Count(iterations, "iteration count"))} : std::nullopt;
+    if (p.isSet(servers)) lexurgy::SetServerCount(Try(Count(servers, "server count")));
+    lexurgy::SetNativeEngineMode(p.isSet(native) ? lexurgy::NativeEngineMode::Enabled : lexurgy::NativeEngineMode::Disabled);
+
+    QFile out;
+    if (p.isSet(output)) {
+        out.setFileName(p.value(output));
+        if (not out.open(QIODevice::WriteOnly | QIODevice::Truncate)) return Error("Could not open output file '{}'", p.value(output));
+    } else if (not out.open(stdout, QIODevice::WriteOnly)) {
+        return Error("Could not write to stdout");
+    }
+
+    auto counts = WordCounts | vws::filter([&](usz n) { return n <= max; }) | rgs::to<std::vector>();
+    if (counts.empty()) return Error("No word counts to benchmark; the smallest one is {}", WordCounts.front());
+    auto words = MakeWords(counts.back());
+
+    QEventLoop loop;
+    json results = json::array();
+    for (auto [name, rule_count] : Rulesets) {
+        auto changes = MakeRuleset(rule_count);
+
+        // Cold start: start Lexurgy from scratch and apply the sound
+        // changes to a handful of words.
+        lexurgy::Close();
+        auto cold = Try(Measure(loop, words.first(counts.front()), changes));
+        std::println(stderr, "{}: cold start {:.1f} ms", name, Ms(cold));
+
+        json runs = json::array();
+        for (auto count : counts) {
+            // Drop cached results so every iteration actually goes through
+            // Lexurgy; do one run first that we don’t measure so we only
+            // measure the steady state.
+            auto n = fixed_iterations.value_or(std::clamp(WordsPerMeasurement / count, MinIterations, MaxIterations));
+            std::vector<chr::nanoseconds> samples;
+            lexurgy::ClearCache();
+            Try(Measure(loop, words.first(count), changes));
+            for (usz i = 0; i < n; i++) {
+                lexurgy::ClearCache();
+                samples.push_back(Try(Measure(loop, words.first(count), changes)));
+            }
+
+            rgs::sort(samples);
+            auto total = std::accumulate(samples.begin(), samples.end(), chr::nanoseconds{});
+            auto p50 = Percentile(samples, .50);
+            auto throughput = double(count) / chr::duration<double>(p50).count();
+            std::println(stderr, "{}: {} words, p50 {:.1f} ms, {:.0f} words/s", name, count, Ms(p50), throughput);
+            runs.push_back({
+                {"words", count},
+                {"iterations", n},
+                {"latency_ms", {
+                    {"min", Ms(samples.front())},
+                    {"mean", Ms(total) / double(n)},
+                    {"p50", Ms(p50)},
+                    {"p90", Ms(Percentile(samples, .90))},
+                    {"p99", Ms(Percentile(samples, .99))},
+                    {"max", Ms(samples.back())},
+                }},
+                {"words_per_second", throughput},
+            });
+        }
+
+        results.push_back({
+            {"ruleset", name},
+            {"rules", rule_count},
+            {"cold_start_ms", Ms(cold)},
+            {"runs", std::move(runs)},
+        });
+    }
+
+    // Close Lexurgy before measuring memory so its processes are included.
+    lexurgy::Close();
+    json j{
+        {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toStdString()},
+        {"system", QSysInfo::prettyProductName().toStdString()},
+        {"cpu", QSysInfo::currentCpuArchitecture().toStdString()},
+#ifdef SMYTH_LEXURGY_JNI
+        {"in_process", *settings::LexurgyInProcess},
+#else
+        {"in_process", false},
+#endif
+        {"native", p.isSet(native)},
+        {"peak_rss", PeakRSS()},
+        {"results", std::move(results)},
+    };
+
+    if (out.write(QByteArray::fromStdString(j.dump(4) + "\n")) == -1) return Error("Failed to write output: {}", out.errorString());
+    return {};
+}
+} // namespace
+
+int batch::Bench(const QStringList& args) {
+    auto res = Run(args);
+    if (res) return 0;
+    std::println(stderr, "Error: {}", res.error());
+    return 1;
+}
@@ -0,0 +1,75 @@
+#include <format>
+#include <Smyth/BigInt.hh>
+
+using namespace smyth;
+
+BigInt::BigInt(u64 value) {
+    while (value != 0) {
+        limbs.push_back(u32(value));
+        value >>= 32;
+    }
+}
+
+auto BigInt::operator+=(const BigInt& other) -> BigInt& {
+    if (limbs.size() < other.limbs.size()) limbs.resize(other.limbs.size());
+    u64 carry = 0;
+    for (usz i = 0; i < limbs.size(); i++) {
+        u64 sum = u64(limbs[i]) + (i < other.limbs.size() ? other.limbs[i] : 0) + carry;
+        limbs[i] = u32(sum);
+        carry = sum >> 32;
+        if (carry == 0 and i >= other.limbs.size()) break;
+    }
+
+    if (carry != 0) limbs.push_back(u32(carry));
+    return *this;
+}
+
+auto BigInt::operator-=(const BigInt& other) -> BigInt& {
+    Assert(*this >= other, "BigInt subtraction underflow");
+    i64 borrow = 0;
+    for (usz i = 0; i < limbs.size(); i++) {
+        i64 diff = i64(limbs[i]) - (i < other.limbs.size() ? other.limbs[i] : 0) - borrow;
+        borrow = diff < 0;
+        limbs[i] = u32(diff + (borrow << 32));
+        if (borrow == 0 and i >= other.limbs.size()) break;
+    }
+
+    Trim();
+    return *this;
+}
+
+auto smyth::operator<=>(const BigInt& a, const BigInt& b) -> std::strong_ordering {
+    if (a.limbs.size() != b.limbs.size()) return a.limbs.size() <=> b.limbs.size();
+    for (usz i = a.limbs.size(); i-- > 0;)
+        if (a.limbs[i] != b.limbs[i])
+            return a.limbs[i] <=> b.limbs[i];
+    return std::strong_ordering::equal;
+}
+
+auto BigInt::str() const -> std::string {
+    if (is_zero()) return "0";
+
+    // Repeatedly divide by 10^9 and collect the remainders.
+    static constexpr u32 Base = 1'000'000'000;
+    auto n = limbs;
+    std::vector<u32> parts;
+    while (not n.empty()) {
+        u64 rem = 0;
+        for (usz i = n.size(); i-- > 0;) {
+            u64 cur = rem << 32 | n[i];
+            n[i] = u32(cur / Base);
+            rem = cur % Base;
+        }
+
+        parts.push_back(u32(rem));
+        while (not n.empty() and n.back() == 0) n.pop_back();
+    }
+
+    auto s = std::to_string(parts.back());
+    for (usz i = parts.size() - 1; i-- > 0;) s += std::format("{:09}", parts[i]);
+    return s;
+}
+
+void BigInt::Trim() {
+    while (not limbs.empty() and limbs.back() == 0) limbs.pop_back();
+}
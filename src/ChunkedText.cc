@@ -0,0 +1,109 @@
+#include <future>
+#include <QFile>
+#include <Smyth/ChunkedText.hh>
+#include <span>
+#include <thread>
+
+using namespace smyth;
+
+ChunkedText::ChunkedText(QString text) {
+    // Don’t copy anything if the text fits in a single chunk.
+    if (text.size() <= ChunkSize) {
+        Add(std::move(text));
+        return;
+    }
+
+    // Otherwise, split it at line breaks, same as when loading a file.
+    QStringView rest = text;
+    while (not rest.isEmpty()) {
+        auto nl = rest.size() > ChunkSize ? rest.indexOf('\n', ChunkSize) : -1;
+        auto end = nl == -1 ? rest.size() : nl + 1;
+        Add(rest.first(end).toString());
+        rest = rest.sliced(end);
+    }
+}
+
+void ChunkedText::Add(QString chunk) {
+    if (chunk.isEmpty()) return;
+
+    // A line that is split across chunks counts only once.
+    auto ends_in_newline = parts.empty() or parts.back().endsWith('\n');
+    line_count += chunk.count('\n') + (chunk.endsWith('\n') ? 0 : 1) - (ends_in_newline ? 0 : 1);
+    total_size += chunk.size();
+    parts.push_back(std::move(chunk));
+}
+
+auto ChunkedText::FromUtf8(QByteArrayView data) -> ChunkedText {
+    // Split the text into chunks at line breaks; since we never split in
+    // the middle of a line, we never split a UTF-8 sequence either.
+    std::vector<QByteArrayView> parts;
+    while (not data.isEmpty()) {
+        auto nl = data.size() > ChunkSize ? data.indexOf('\n', ChunkSize) : -1;
+        auto end = nl == -1 ? data.size() : nl + 1;
+        parts.push_back(data.first(end));
+        data = data.sliced(end);
+    }
+
+    // And decode them in parallel, a few at a time.
+    auto Decode = [](QByteArrayView bytes) {
+        auto s = QString::fromUtf8(bytes);
+        s.replace(u"\r\n", u"\n");
+        return s;
+    };
+
+    ChunkedText text;
+    auto threads = usz(std::max(1u, std::thread::hardware_concurrency()));
+    for (usz i = 0; i < parts.size(); i += threads) {
+        std::vector<std::future<QString>> futures;
+        for (auto p : std::span{parts}.subspan(i, std::min(threads, parts.size() - i)))
+            futures.push_back(std::async(std::launch::async, Decode, p));
+        for (auto& fut : futures) text.Add(fut.get());
+    }
+
+    return text;
+}
+
+auto ChunkedText::Map(const QString& path) -> Result<ChunkedText> {
+    QFile f{path};
+    if (not f.open(QIODevice::ReadOnly)) return Error("Could not open file '{}'", path.toStdString());
+
+    // Map the file if we can; fall back to reading it otherwise.
+    QByteArray contents;
+    QByteArrayView data;
+    auto size = f.size();
+    auto mapped = size != 0 ? f.map(0, size) : nullptr;
+    if (mapped) {
+        data = QByteArrayView{mapped, size};
+    } else {
+        contents = f.readAll();
+        data = contents;
+    }
+
+    // Skip the BOM, if any.
+    if (data.startsWith("\xEF\xBB\xBF")) data = data.sliced(3);
+    auto text = FromUtf8(data);
+    if (mapped) f.unmap(mapped);
+    return text;
+}
+
+auto ChunkedText::preview(qsizetype max_lines) const -> QString {
+    QString out;
+    for (const auto& c : parts) {
+        for (qsizetype pos = 0; pos < c.size();) {
+            if (max_lines-- == 0) return out;
+            auto nl = c.indexOf('\n', pos);
+            auto end = nl == -1 ? c.size() : nl + 1;
+            out += QStringView{c}.sliced(pos, end - pos);
+            pos = end;
+        }
+    }
+    return out;
+}
+
+auto ChunkedText::str() const -> QString {
+    if (parts.size() == 1) return parts.front();
+    QString joined;
+    joined.reserve(total_size);
+    for (const auto& c : parts) joined += c;
+    return joined;
+}
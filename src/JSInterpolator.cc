@@ -0,0 +1,161 @@
+#include <UI/JSInterpolator.hh>
+#include <UI/Utils.hh>
+
+using namespace smyth;
+using namespace smyth::ui;
+
+// ====================================================================
+//  Initialisation
+// ====================================================================
+JSInterpolator::JSInterpolator() {
+    Restart();
+    watchdog = std::jthread([this](std::stop_token stop) { Watch(std::move(stop)); });
+}
+
+JSInterpolator::~JSInterpolator() noexcept {
+    watchdog.request_stop();
+    watchdog_cv.notify_all();
+}
+
+// ====================================================================
+//  API
+// ====================================================================
+auto JSInterpolator::interpolate(QString& text) -> Result<> {
+    struct Block {
+        qsizetype begin;
+        qsizetype end;
+        QString expression;
+    };
+
+    // Find all blocks first.
+    std::vector<Block> blocks;
+    for (qsizetype pos = 0;;) {
+        auto next = text.indexOf("§{", pos);
+        if (next == -1) break;
+        auto end = text.indexOf("}§", next);
+        if (end == -1) break;
+        blocks.emplace_back(next, end + 2, text.mid(next + 2, end - next - 2));
+        pos = end + 2;
+    }
+
+    // We can only reuse results if everything we’ve evaluated in this
+    // engine so far is a prefix of what we need to evaluate now, since
+    // otherwise the engine may be in a state that the expressions we’re
+    // about to evaluate don’t expect.
+    usz reused = 0;
+    while (
+        reused < history.size() and
+        reused < blocks.size() and
+        history[reused].expression == blocks[reused].expression
+    ) reused++;
+    if (reused != history.size()) {
+        Restart();
+        reused = 0;
+    }
+
+    // Evaluate everything we haven’t evaluated yet.
+    last_timings.clear();
+    auto until = chr::steady_clock::now() + Budget;
+    for (auto [i, b] : blocks | vws::enumerate) {
+        if (usz(i) < reused) {
+            last_timings.emplace_back(b.expression, history[usz(i)].time, true);
+            continue;
+        }
+
+        auto start = chr::steady_clock::now();
+        auto res = Evaluate(b.expression, until);
+        auto time = chr::duration_cast<chr::nanoseconds>(chr::steady_clock::now() - start);
+        last_timings.emplace_back(b.expression, time, false);
+
+        // We don’t know what state an error leaves the engine in.
+        if (not res) {
+            Restart();
+            return Error("{}", res.error());
+        }
+
+        history.emplace_back(b.expression, std::move(*res), time);
+    }
+
+    // And splice in the results; null and undefined are not inserted.
+    QString out;
+    qsizetype pos = 0;
+    for (auto [i, b] : blocks | vws::enumerate) {
+        out += QStringView{text}.sliced(pos, b.begin - pos);
+        if (auto& r = history[usz(i)].result) out += *r;
+        pos = b.end;
+    }
+
+    out += QStringView{text}.sliced(pos);
+    text = std::move(out);
+    return {};
+}
+
+void JSInterpolator::reset() {
+    Restart();
+    last_timings.clear();
+}
+
+// ====================================================================
+//  Implementation
+// ====================================================================
+auto JSInterpolator::Evaluate(
+    const QString& expr,
+    chr::steady_clock::time_point until
+) -> Result<std::optional<QString>> {
+    // Arm the watchdog.
+    {
+        std::unique_lock _{watchdog_mutex};
+        deadline = until;
+    }
+    watchdog_cv.notify_all();
+
+    auto result = engine->evaluate(expr);
+
+    // And disarm it again.
+    {
+        std::unique_lock _{watchdog_mutex};
+        deadline = std::nullopt;
+    }
+
+    if (engine->isInterrupted()) return Error(
+        "JS Evaluation took longer than {} ms; aborted while evaluating:\n{}",
+        Budget.count(),
+        expr
+    );
+
+    if (result.isError()) return Error(
+        "Exception in JS Evaluation: {}\nWhile evaluating:\n{}",
+        result.toString(),
+        expr
+    );
+
+    if (result.isNull() or result.isUndefined()) return std::nullopt;
+    return result.toString();
+}
+
+void JSInterpolator::Restart() {
+    auto e = std::make_unique<QJSEngine>();
+    e->installExtensions(QJSEngine::ConsoleExtension);
+    history.clear();
+
+    // The watchdog may be looking at the old engine.
+    std::unique_lock _{watchdog_mutex};
+    engine = std::move(e);
+}
+
+void JSInterpolator::Watch(std::stop_token stop) {
+    std::unique_lock lock{watchdog_mutex};
+    while (not stop.stop_requested()) {
+        if (not deadline) {
+            watchdog_cv.wait(lock, stop, [&] { return deadline.has_value(); });
+            continue;
+        }
+
+        // Interrupt the engine if it hasn’t finished by the deadline. This
+        // is one of the few things that are safe to do from another thread.
+        auto until = *deadline;
+        if (watchdog_cv.wait_until(lock, stop, until, [&] { return deadline != until; })) continue;
+        if (deadline == until) engine->setInterrupted(true);
+        deadline = std::nullopt;
+    }
+}
@@ -1,22 +1,380 @@
+#include <deque>
+#include <base/FS.hh>
 #include <print>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
 #include <QProcess>
+#include <QSet>
+#include <QTimer>
 #include <ranges>
+#include <span>
 #include <Smyth/JSON.hh>
+#include <Smyth/NativeEngine.hh>
+#include <Smyth/Trace.hh>
 #include <Smyth/Utils.hh>
 #include <UI/Lexurgy.hh>
+#include <UI/LexurgyBackend.hh>
+#include <UI/LexurgyProtocol.hh>
 #include <UI/Smyth.hh>
+#include <unordered_map>
 
 using namespace smyth;
 using namespace smyth::ui;
+using namespace smyth::lexurgy;
+using namespace smyth::lexurgy::detail;
 using json = json_utils::json;
 
 namespace {
+/// Cache of results for words that we’ve already seen.
+///
+/// Results only depend on the sound changes, the rules to start at and
+/// stop before, and the word itself, so we only ever need to send words
+/// that we haven’t seen before with the same sound changes. The cache is
+/// invalidated entirely whenever the sound changes change.
+class ResultCache {
+public:
+    /// Maps input words to output words.
+    using Table = QHash<QString, QString>;
+
+private:
+    /// Don’t let the cache grow without bounds.
+    static constexpr usz MaxEntries = 1 << 21;
+
+    /// The sound changes that the cached results are for.
+    QString changes;
+
+    /// Results, keyed by the start and stop rules.
+    QHash<QString, Table> tables;
+    usz entries = 0;
+
+    /// Incremented whenever the cache is invalidated; this is so results
+    /// of requests that were sent before that aren’t added back to it.
+    u64 generation = 0;
+
+    /// Whether results are cached at all.
+    bool enabled = true;
+
+public:
+    /// Insert a result.
+    void add(Table& t, QString word, QString result);
+
+    /// Drop all cached results.
+    void clear();
+
+    /// Get the current generation.
+    auto current_generation() const -> u64 { return generation; }
+
+    /// Enable or disable the cache; disabling it drops everything in it.
+    void enable(bool e) {
+        enabled = e;
+        if (not e) clear();
+    }
+
+    /// Check whether results are cached.
+    auto is_enabled() const -> bool { return enabled; }
+
+    /// Get the table for a set of sound changes, invalidating
+    /// the cache if they differ from the current ones.
+    auto get(const QString& changes, const QString& start, const QString& stop) -> Table&;
+
+    /// Load the cache from disk.
+    auto load(const QString& path) -> Result<>;
+
+    /// Save the cache to disk.
+    auto save(const QString& path) const -> Result<>;
+
+private:
+    static auto Key(const QString& start, const QString& stop) -> QString {
+        return start + QChar(0) + stop;
+    }
+};
+
+ResultCache Cache;
+
+void ResultCache::add(Table& t, QString word, QString result) {
+    if (entries >= MaxEntries) {
+        // Don’t bump the generation here; the sound changes are still
+        // the same, so what’s in flight is still valid.
+        for (auto& table : tables) table.clear();
+        entries = 0;
+    }
+
+    t.insert(std::move(word), std::move(result));
+    entries++;
+}
+
+void ResultCache::clear() {
+    changes.clear();
+    tables.clear();
+    entries = 0;
+    generation++;
+}
+
+auto ResultCache::get(const QString& new_changes, const QString& start, const QString& stop) -> Table& {
+    if (new_changes != changes) {
+        clear();
+        changes = new_changes;
+    }
+
+    return tables[Key(start, stop)];
+}
+
+auto ResultCache::load(const QString& path) -> Result<> {
+    QFile f{path};
+    if (not f.exists()) return {};
+    if (not f.open(QIODevice::ReadOnly)) return Error("Could not open '{}'", path);
+
+    auto j = Try(json_utils::Parse(f.readAll().toStdString()));
+    const json::object_t& obj = Try(json_utils::Get<json::object_t>(j));
+    if (not obj.contains("changes") or not obj.contains("tables")) return Error(
+        "Invalid Lexurgy cache file '{}'",
+        path
+    );
+
+    clear();
+    const std::string& ch = Try(json_utils::Get<std::string>(j["changes"]));
+    changes = QString::fromStdString(ch);
+    const json::array_t& arr = Try(json_utils::Get<json::array_t>(j["tables"]));
+    for (const auto& e : arr) {
+        if (not e.contains("start") or not e.contains("stop") or not e.contains("words")) return Error(
+            "Invalid table in Lexurgy cache file '{}'",
+            path
+        );
+
+        const std::string& start = Try(json_utils::Get<std::string>(e["start"]));
+        const std::string& stop = Try(json_utils::Get<std::string>(e["stop"]));
+        auto& t = tables[Key(QString::fromStdString(start), QString::fromStdString(stop))];
+
+        const json::object_t& words = Try(json_utils::Get<json::object_t>(e["words"]));
+        for (const auto& [word, result] : words) {
+            const std::string& r = Try(json_utils::Get<std::string>(result));
+            add(t, QString::fromStdString(word), QString::fromStdString(r));
+        }
+    }
+
+    return {};
+}
+
+auto ResultCache::save(const QString& path) const -> Result<> {
+    json::array_t arr;
+    for (auto [key, table] : tables.asKeyValueRange()) {
+        if (table.isEmpty()) continue;
+        auto sep = key.indexOf(QChar(0));
+        json::object_t words;
+        for (auto [word, result] : table.asKeyValueRange())
+            words[word.toStdString()] = result.toStdString();
+        arr.push_back(json{
+            {"start", key.left(sep).toStdString()},
+            {"stop", key.mid(sep + 1).toStdString()},
+            {"words", std::move(words)},
+        });
+    }
+
+    json j;
+    j["changes"] = changes.toStdString();
+    j["tables"] = std::move(arr);
+    return File::Write(path.toStdString(), j.dump());
+}
+
+/// A single Lexurgy server process that we talk to over a pipe.
+///
+/// The server also supervises its process: every request that is sent
+/// has a deadline, and if Lexurgy crashes or fails to respond in time,
+/// the process is restarted, the sound changes are loaded again, and
+/// the request is retried. Requests that keep failing and processes
+/// that keep crashing are reported as errors.
+class Server final : public Backend {
+    /// How long Lexurgy may take to respond to any request.
+    static constexpr chr::milliseconds BaseDeadline{30'000};
+
+    /// How much longer an apply may take per word.
+    static constexpr chr::microseconds DeadlinePerWord{2'000};
+
+    /// How often a request may be sent before we give up on it.
+    static constexpr u32 MaxAttempts = 2;
+
+    /// How often the process may be restarted without answering a
+    /// single request in between.
+    static constexpr u32 MaxRestarts = 3;
+
+    /// How much of Lexurgy’s stderr to keep for error messages.
+    static constexpr qsizetype MaxErrorOutput = 4'096;
+
+    /// A request that has not been answered yet.
+    ///
+    /// Lexurgy processes requests strictly in order, and we only ever
+    /// have one request in flight; everything else waits in the queue
+    /// so that superseded requests can be dropped before they are sent.
+    struct Pending {
+        enum struct Kind {
+            LoadChanges,
+            Apply,
+        };
+
+        /// The request this belongs to; an apply may be preceded by
+        /// a request to load the sound changes, and both share an id.
+        RequestId id;
+        Kind kind;
+
+        /// The serialised request, for applies; the sound changes to
+        /// load, which are also kept for applies in case we have to load
+        /// them again after a restart.
+        std::string line;
+        QString changes;
+
+        /// Number of words in an apply, for computing its deadline.
+        usz words = 0;
+
+        /// Callback to invoke once we have a result.
+        Callback callback;
+
+        /// The run this is part of, for tracing.
+        trace::RunId run = trace::CurrentRun();
+
+        /// How often this has been sent to Lexurgy.
+        u32 attempts = 0;
+
+        /// Set if the request was cancelled.
+        bool cancelled = false;
+    };
+
+    /// This is replaced on restart; the old process may take a while
+    /// to die, and we don’t want to wait for that.
+    std::unique_ptr<QProcess> lexurgy_process = std::make_unique<QProcess>();
+    ResponseReader reader;
+
+    /// Fires if the request in flight takes too long.
+    QTimer deadline;
+
+    /// The last few KB that Lexurgy wrote to stderr. We need to read it
+    /// anyway so the pipe never fills up, and it helps explain crashes.
+    QByteArray error_output;
+
+    /// How often the process has been restarted since it last
+    /// answered a request.
+    u32 restarts = 0;
+
+    /// Requests that have yet to be answered; if `in_flight` is
+    /// set, the first one has been sent to Lexurgy.
+    std::deque<Pending> queue;
+    bool in_flight = false;
+
+    /// Set once this server has been shut down; nothing that is
+    /// still pending will be reported after that.
+    bool closed = false;
+
+    /// The sound changes that Lexurgy currently has loaded; this
+    /// avoids pointless requests.
+    std::optional<QString> sound_changes;
+
+public:
+    Server() = default;
+    ~Server() override;
+
+    void Apply(
+        RequestId id,
+        QString changes,
+        std::span<const QStringView> words,
+        QStringView start_at,
+        QStringView stop_before,
+        Callback cb
+    ) override;
+
+    void Cancel(RequestId id) override;
+    void Close() override;
+    bool Idle() const override { return queue.empty(); }
+    bool InProcess() const override { return false; }
+    bool Running() const override { return lexurgy_process->state() != QProcess::NotRunning; }
+    auto Start() -> Result<> override;
+
+private:
+    /// Check a response for errors.
+    static auto CheckResponse(
+        Result<ResponseReader::Response> res
+    ) -> Result<ResponseReader::Response>;
+
+    /// Connect to the process’s signals once it has started.
+    auto Connect() -> Result<>;
+
+    /// Fail all pending requests.
+    void FailAll(const std::string& message);
+
+    /// Format an error message that includes what Lexurgy last wrote
+    /// to stderr, if anything.
+    auto FormatError(std::string_view reason) const -> std::string;
+
+    /// Kill the process and start a new one.
+    auto Restart() -> Result<>;
+
+    /// Handle the process crashing or failing to respond by restarting
+    /// it and retrying whatever was in flight.
+    void Recover(std::string_view reason);
+
+    /// Handle a response from Lexurgy.
+    void HandleResponse(Result<ResponseReader::Response> res);
+
+    /// Read stderr and keep only the tail of it.
+    void ReadErrors();
+
+    /// Read data from Lexurgy.
+    void ReadOutput();
+
+    /// Send the next request in the queue, if any.
+    void SendNext();
+};
+
+/// A pool of Lexurgy servers.
+///
+/// Lexurgy is single-threaded, so to make use of more than one core, we
+/// run several servers, split the input into contiguous chunks, apply the
+/// sound changes to each chunk on a different server, and then stitch the
+/// results back together in order. Sound changes apply to each word in
+/// isolation, so this does not affect the result.
 class Connexion {
     LIBBASE_IMMOVABLE(Connexion);
-    QProcess lexurgy_process;
 
-    /// Cache the sound changes to avoid pointless requests.
-    std::optional<QString> sound_changes;
+    /// Don’t bother splitting inputs that are smaller than this.
+    static constexpr usz MinWordsPerShard = 512;
+
+    /// How many words to use to warm up a server.
+    static constexpr usz PrewarmWords = 32;
+
+    /// A request whose chunks are being processed by one or more servers.
+    struct Job {
+        std::vector<QString> parts;
+        usz remaining;
+        Callback callback;
+    };
+
+    /// State of a profiling request.
+    struct ProfileState {
+        std::vector<RuleProfile> results;
+        std::vector<QString> rules;
+        QString changes;
+        QStringList words;
+        chr::steady_clock::time_point start;
+    };
+
+    std::vector<std::unique_ptr<Backend>> servers;
+    std::unordered_map<RequestId, std::shared_ptr<Job>> jobs;
+
+    /// The native engine for the most recent sound changes, if it
+    /// supports them.
+    std::optional<QString> native_changes;
+    std::optional<sca::Engine> native;
+
+    /// Why the native engine doesn’t support the most recent sound
+    /// changes, if it doesn’t.
+    std::string native_error;
+
+    /// Why the native engine was not used for the most recent request,
+    /// if it was enabled but couldn’t be used.
+    std::optional<std::string> native_fallback;
+
+    /// The id of the next request. This is global so ids stay unique
+    /// even if the connexion is replaced.
+    static RequestId NextId;
 
     /// Unique ptr so we can replace it.
     static std::unique_ptr<Connexion> Instance;
@@ -24,124 +382,855 @@ class Connexion {
     Connexion() = default;
 
 public:
-    ~Connexion();
+    /// Number of servers to use instead of the user’s setting, if any.
+    static std::optional<usz> ServerCount;
 
-    /// Close the connexion.
-    static void Close();
+    /// When to use the native engine instead of the user’s setting, if
+    /// anything was specified.
+    static std::optional<NativeEngineMode> NativeMode;
 
-    /// Try to create a new process and wait until it has started.
-    static auto Get() -> Result<Connexion&>;
+    ~Connexion() = default;
 
-    /// Apply sound changes.
+    /// Apply sound changes to text that is split into chunks at line breaks.
     auto Apply(
-        QStringView input,
+        std::span<const QStringView> input,
         QString changes,
         const QString& start_after,
-        const QString& stop_before
-    ) -> Result<QString>;
+        const QString& stop_before,
+        Callback cb
+    ) -> Result<RequestId>;
+
+    /// Cancel a request.
+    void Cancel(RequestId id);
+
+    /// Close the connexion.
+    static void Close();
+
+    /// Profile sound changes.
+    auto Profile(
+        QStringView input,
+        QString changes,
+        std::vector<QString> rules,
+        ProfileCallback cb
+    ) -> Result<RequestId>;
+
+    /// Start all servers and load the sound changes.
+    auto Prewarm(QStringView input, QString changes, Callback cb) -> Result<RequestId>;
+
+    /// Get the connexion, creating it if it doesn’t exist.
+    static auto Get() -> Connexion&;
 
-    /// Update sound changes.
-    auto UpdateSoundChanges(QString changes) -> Result<>;
+    /// Get the connexion if it exists.
+    static auto GetIfExists() -> Connexion* { return Instance.get(); }
 
+    /// Get why the native engine was not used for the most recent request.
+    auto native_fallback_reason() const -> std::optional<std::string> { return native_fallback; }
 
 private:
-    auto SendRequest(const json& request) -> Result<json>;
-    static auto Start() -> Result<std::unique_ptr<Connexion>>;
+    /// Send words to Lexurgy, splitting them across servers.
+    auto Dispatch(
+        RequestId id,
+        std::span<const QStringView> words,
+        const QString& changes,
+        const QString& start_after,
+        const QString& stop_before,
+        Callback cb
+    ) -> Result<>;
+
+    /// Get the native engine for a set of sound changes, if it
+    /// supports them.
+    auto GetNativeEngine(const QString& changes) -> const sca::Engine*;
+
+    /// Get when to use the native engine.
+    static auto GetNativeMode() -> NativeEngineMode;
+
+    /// Get a server that is running, (re)starting it if need be.
+    auto GetServer(usz index) -> Result<Backend&>;
+
+    /// Profile the next rule.
+    auto ProfileNext(
+        RequestId id,
+        std::shared_ptr<Job> job,
+        std::shared_ptr<ProfileState> state
+    ) -> Result<>;
+
+    /// Update the number of servers to match the user’s settings.
+    void Resize();
+
+    /// Check whether the user wants to run Lexurgy inside Smyth.
+    static bool UseInProcessBackend();
 };
 
 std::unique_ptr<Connexion> Connexion::Instance;
+std::optional<usz> Connexion::ServerCount;
+std::optional<NativeEngineMode> Connexion::NativeMode;
+RequestId Connexion::NextId = 1;
 
-Connexion::~Connexion() { lexurgy_process.close(); }
+// =====================================================================
+//  Server
+// =====================================================================
+Server::~Server() {
+    Close();
+}
 
-auto Connexion::Apply(
-    QStringView input,
+void Server::Apply(
+    RequestId id,
     QString changes,
-    const QString& start_after,
-    const QString& stop_before
-) -> Result<QString> {
-    Try(UpdateSoundChanges(std::move(changes)));
-
-    std::vector<std::string> words;
-    for (auto w : input | vws::split('\n') | vws::filter([](auto&& w) { return not w.empty(); })) {
-        auto sv = QStringView{w.begin(), w.end() - w.begin()};
-        words.push_back(sv.toString().toStdString());
-    }
-
-    std::optional<std::string> start_after_opt;
-    std::optional<std::string> stop_before_opt;
-    if (start_after != "") start_after_opt = start_after.toStdString();
-    if (stop_before != "") stop_before_opt = stop_before.toStdString();
-    json req;
-    req["type"] = "apply";
-    req["words"] = words;
-    if (start_after_opt) req["startAt"] = *start_after_opt;
-    if (stop_before_opt) req["stopBefore"] = *stop_before_opt;
-    auto changed = Try(SendRequest(req));
-    if (changed["type"] != "changed") return Error(
+    std::span<const QStringView> words,
+    QStringView start_at,
+    QStringView stop_before,
+    Callback cb
+) {
+    // Make sure the right sound changes are loaded first; whether we
+    // actually need to send them is only decided once this reaches the
+    // front of the queue since the requests before it may still change
+    // what Lexurgy has loaded.
+    queue.push_back(Pending{
+        .id = id,
+        .kind = Pending::Kind::LoadChanges,
+        .line = "",
+        .changes = changes,
+        .callback = {},
+    });
+
+    queue.push_back(Pending{
+        .id = id,
+        .kind = Pending::Kind::Apply,
+        .line = [&] {
+            trace::Timer _{"encode request"};
+            return EncodeApply(words, start_at, stop_before);
+        }(),
+        .changes = std::move(changes),
+        .words = words.size(),
+        .callback = std::move(cb),
+    });
+
+    SendNext();
+}
+
+void Server::Cancel(RequestId id) {
+    for (auto& p : queue)
+        if (p.id == id)
+            p.cancelled = true;
+}
+
+auto Server::CheckResponse(
+    Result<ResponseReader::Response> res
+) -> Result<ResponseReader::Response> {
+    auto r = Try(std::move(res));
+    if (not r.header.contains("type")) return Error("Missing 'type' field in response");
+    if (r.header["type"] == "error") {
+        if (not r.header.contains("message")) return Error("Lexurgy error: Unknown error");
+        return Error("Lexurgy error: {}", r.header["message"].get<std::string>());
+    }
+    return r;
+}
+
+void Server::Close() {
+    if (closed) return;
+    closed = true;
+    queue.clear();
+    in_flight = false;
+    deadline.stop();
+    deadline.disconnect();
+    lexurgy_process->disconnect();
+    lexurgy_process->close();
+}
+
+void Server::FailAll(const std::string& message) {
+    auto pending = std::exchange(queue, {});
+    in_flight = false;
+    deadline.stop();
+    sound_changes = std::nullopt;
+    for (auto& p : pending) {
+        if (closed) return;
+        if (p.callback and not p.cancelled)
+            p.callback(Error("{}", message));
+    }
+}
+
+auto Server::FormatError(std::string_view reason) const -> std::string {
+    auto output = QString::fromUtf8(error_output).trimmed();
+    if (output.isEmpty()) return std::format("Lexurgy error: {}", reason);
+    return std::format("Lexurgy error: {}\n\nLexurgy output:\n{}", reason, output);
+}
+
+void Server::HandleResponse(Result<ResponseReader::Response> response) {
+    // Ignore spurious output.
+    if (not in_flight) return;
+    auto res = CheckResponse(std::move(response));
+
+    // We’re done with this one. Lexurgy answered, so it’s healthy, even
+    // if the answer is an error.
+    auto p = std::move(queue.front());
+    queue.pop_front();
+    in_flight = false;
+    deadline.stop();
+    restarts = 0;
+
+    // Update what sound changes Lexurgy has loaded.
+    if (p.kind == Pending::Kind::LoadChanges) {
+        auto CheckOk = [&] -> Result<> {
+            auto r = Try(std::move(res));
+            if (r.header["type"] != "ok") return Error(
+                "Lexurgy error: Unexpected response type for setting sound changes '{}'",
+                r.header["type"].get<std::string>()
+            );
+            return {};
+        };
+
+        // On success, proceed with the apply that comes after this.
+        auto ok = CheckOk();
+        if (ok.has_value()) {
+            sound_changes = std::move(p.changes);
+            return SendNext();
+        }
+
+        // Otherwise, the apply request is pointless; drop it and report
+        // the error instead. We don’t know what Lexurgy has loaded now,
+        // so make sure to send the changes again next time.
+        sound_changes = std::nullopt;
+        Assert(not queue.empty() and queue.front().id == p.id, "Load request without apply?");
+        auto apply = std::move(queue.front());
+        queue.pop_front();
+        SendNext();
+        if (not apply.cancelled) apply.callback(Error("{}", ok.error()));
+        return;
+    }
+
+    // This was an apply; send the next request before invoking the
+    // callback, since the latter may well issue a new request.
+    SendNext();
+    if (p.cancelled) return;
+    if (not res.has_value()) return p.callback(Error("{}", res.error()));
+    if (res->header["type"] != "changed") return p.callback(Error(
         "Lexurgy error: Unexpected response type '{}'",
-        changed["type"].get<std::string>()
-    );
+        res->header["type"].get<std::string>()
+    ));
 
-    QString joined;
-    for (const auto& w : changed["words"].get<std::vector<std::string>>()) {
-        joined += w;
-        joined += '\n';
+    p.callback(std::move(res->words));
+}
+
+void Server::ReadErrors() {
+    error_output += lexurgy_process->readAllStandardError();
+    if (error_output.size() > MaxErrorOutput) error_output.remove(0, error_output.size() - MaxErrorOutput);
+}
+
+void Server::Recover(std::string_view reason) {
+    deadline.stop();
+    ReadErrors();
+    auto message = FormatError(reason);
+
+    // Take out whatever Lexurgy was working on when it happened.
+    std::optional<Pending> failed;
+    if (in_flight) {
+        failed = std::move(queue.front());
+        queue.pop_front();
+        in_flight = false;
     }
-    return joined;
+
+    // If the process died while idle, leave it be; it will be replaced
+    // the next time it is needed.
+    sound_changes = std::nullopt;
+    if (not failed and queue.empty()) return;
+
+    // If the process keeps dying, something is seriously wrong; report
+    // that instead of trying forever. The next request will start over
+    // with a fresh process.
+    if (++restarts > MaxRestarts) {
+        if (failed) queue.push_front(std::move(*failed));
+        lexurgy_process->disconnect();
+        lexurgy_process->kill();
+        return FailAll(std::format("{}\n\nLexurgy was restarted {} times without responding; giving up.", message, MaxRestarts));
+    }
+
+    // Retry the request unless it has already failed too often. A load
+    // request has to be retried together with its apply. The restarted
+    // process has nothing loaded, so an apply needs its changes again.
+    Callback report;
+    if (failed and not failed->cancelled) {
+        if (failed->attempts < MaxAttempts) {
+            if (failed->kind == Pending::Kind::Apply) {
+                queue.push_front(std::move(*failed));
+                queue.push_front(Pending{
+                    .id = queue.front().id,
+                    .kind = Pending::Kind::LoadChanges,
+                    .line = "",
+                    .changes = queue.front().changes,
+                    .callback = {},
+                    .run = queue.front().run,
+                });
+            } else {
+                queue.push_front(std::move(*failed));
+            }
+        } else if (failed->kind == Pending::Kind::Apply) {
+            report = std::move(failed->callback);
+        } else {
+            Assert(not queue.empty() and queue.front().id == failed->id, "Load request without apply?");
+            auto apply = std::move(queue.front());
+            queue.pop_front();
+            if (not apply.cancelled) report = std::move(apply.callback);
+        }
+    }
+
+    // Start a new process and carry on with the queue before reporting
+    // anything since the callback may well issue a new request.
+    auto started = Restart();
+    if (not started.has_value()) {
+        message = std::format("{}\n\n{}", message, started.error());
+        FailAll(message);
+        if (report and not closed) report(Error("{}", message));
+        return;
+    }
+
+    SendNext();
+    if (report) report(Error("{}\n\nThe request failed {} times; giving up.", message, MaxAttempts));
 }
 
-void Connexion::Close() {
-    Instance.reset();
+auto Server::Restart() -> Result<> {
+    // Don’t block the GUI thread until the old process is gone; just
+    // delete it once it is. We may be in the middle of handling one of
+    // its signals, so don’t delete it right away in any case.
+    auto old = lexurgy_process.release();
+    old->disconnect();
+    if (old->state() == QProcess::NotRunning) {
+        old->deleteLater();
+    } else {
+        QObject::connect(old, &QProcess::finished, old, &QObject::deleteLater);
+        old->kill();
+    }
+
+    lexurgy_process = std::make_unique<QProcess>();
+    reader.reset();
+    error_output.clear();
+    return Start();
 }
 
-auto Connexion::Get() -> Result<Connexion&> {
-    if (not Instance) Instance = Try(Start());
-    return *Instance;
+void Server::ReadOutput() {
+    // Handle responses one at a time; the callbacks invoked while handling
+    // a response may close the connexion, in which case we must not report
+    // anything else. Deleting the server is deferred, so accessing our own
+    // members here is fine.
+    {
+        trace::Scope scope{in_flight ? queue.front().run : 0};
+        trace::Timer _{"parse response"};
+        reader.feed(lexurgy_process->readAllStandardOutput());
+    }
+
+    while (not closed) {
+        auto res = reader.take();
+        if (not res) break;
+        HandleResponse(std::move(*res));
+    }
 }
 
-auto Connexion::SendRequest(const json& request) -> Result<json> {
-    auto req = request.dump();
+void Server::SendNext() {
+    while (not in_flight and not queue.empty()) {
+        auto& p = queue.front();
+
+        // Drop cancelled requests. If a load request was cancelled, the
+        // apply that belongs to it was cancelled as well.
+        if (p.cancelled) {
+            queue.pop_front();
+            continue;
+        }
+
+        // Skip loading sound changes that are already loaded.
+        if (p.kind == Pending::Kind::LoadChanges) {
+            if (p.changes == sound_changes) {
+                queue.pop_front();
+                continue;
+            }
+
+            trace::Scope scope{p.run};
+            trace::Timer _{"encode request"};
+            p.line = EncodeLoadChanges(p.changes);
+        }
+
 #ifdef LIBBASE_DEBUG
-    if (*settings::DumpJsonRequests) std::println(stderr, " -> Lexurgy: {}", req);
+        if (*settings::DumpJsonRequests) std::println(stderr, " -> Lexurgy: {}", p.line);
 #endif
-    lexurgy_process.write(req.data(), qint64(req.size()));
-    lexurgy_process.write("\n");
-    lexurgy_process.waitForReadyRead(5'000);
-    auto line = lexurgy_process.readLine();
-    std::string_view sv = {line.data(), usz(line.size())};
-
-    /// Parse the response.
-    auto res = Try(json_utils::Parse(sv));
-    if (not res.contains("type")) return Error("Missing 'type' field in response");
-    if (res["type"] == "error") {
-        if (not res.contains("message")) return Error("Lexurgy error: Unknown error");
-        return Error("Lexurgy error: {}", res["message"].get<std::string>());
-    }
-    return res;
-}
-
-auto Connexion::Start() -> Result<std::unique_ptr<Connexion>> {
-    std::unique_ptr<Connexion> ptr{new Connexion};
-    ptr->lexurgy_process.start(LEXURGY_ROOT "/bin/lexurgy", QStringList() << "server");
-    if (not ptr->lexurgy_process.waitForStarted(5'000)) return Error(
+
+        lexurgy_process->write(p.line.data(), qint64(p.line.size()));
+        lexurgy_process->write("\n");
+        in_flight = true;
+        p.attempts++;
+
+        // Give Lexurgy time proportional to the amount of work.
+        auto time = BaseDeadline + chr::duration_cast<chr::milliseconds>(DeadlinePerWord * p.words);
+        deadline.start(time);
+    }
+}
+
+auto Server::Start() -> Result<> {
+    // If we have a CDS archive, start the JVM ourselves so we can use it;
+    // otherwise, just use the script that ships with Lexurgy. The archive
+    // is empty if the build failed to create it.
+#ifdef LEXURGY_CDS_ARCHIVE
+    if (QFileInfo{LEXURGY_CDS_ARCHIVE}.size() > 0) {
+        lexurgy_process->start(LEXURGY_JAVA, QStringList{
+            "-XX:SharedArchiveFile=" LEXURGY_CDS_ARCHIVE,
+            "-Xshare:auto",             // Don’t fail if the archive is unusable.
+            "-Xlog:disable",            // Logging goes to stdout, where our responses are, so
+            "-Xlog:all=warning:stderr", // move warnings, e.g. about the archive, to stderr.
+            "-XX:+UseSerialGC",         // Fastest to start, and Lexurgy is single-threaded anyway.
+            "-XX:-UsePerfData",         // Don’t create an hsperfdata file.
+            "-cp",
+            LEXURGY_CLASSPATH,
+            "com.meamoria.lexurgy.cli.MainKt",
+            "server",
+        });
+
+        if (lexurgy_process->waitForStarted(5'000)) return Connect();
+    }
+#endif
+
+    lexurgy_process->start(LEXURGY_ROOT "/bin/lexurgy", QStringList() << "server");
+    if (not lexurgy_process->waitForStarted(5'000)) return Error(
         "Failed to start lexurgy process. Expected lexurgy at '{}'",
         LEXURGY_ROOT "/bin/lexurgy"
     );
-    return std::move(ptr);
+
+    return Connect();
 }
 
-auto Connexion::UpdateSoundChanges(QString changes) -> Result<> {
-    auto tr = std::move(changes).trimmed();
-    if (tr == sound_changes) return {};
-    auto res = Try(SendRequest(json{{"type", "load_string"}, {"changes", tr.toStdString()}}));
-    if (res["type"] != "ok") return Error(
-        "Lexurgy error: Unexpected response type for setting sound changes '{}'",
-        res["type"].get<std::string>()
-    );
+auto Server::Connect() -> Result<> {
+    // Responses are handled as they arrive rather than by blocking the
+    // GUI thread until Lexurgy is done.
+    QObject::connect(lexurgy_process.get(), &QProcess::readyReadStandardOutput, [this] {
+        ReadOutput();
+    });
+
+    // Keep reading stderr; if we didn’t, a JVM that logs a lot would
+    // eventually block on a full pipe.
+    QObject::connect(lexurgy_process.get(), &QProcess::readyReadStandardError, [this] {
+        ReadErrors();
+    });
+
+    // If the process dies or hangs, none of the pending requests will
+    // ever get a response, so restart it and retry them.
+    QObject::connect(lexurgy_process.get(), &QProcess::finished, [this](int code, QProcess::ExitStatus status) {
+        if (status == QProcess::CrashExit) Recover("The Lexurgy process crashed");
+        else Recover(std::format("The Lexurgy process exited unexpectedly with code {}", code));
+    });
+
+    deadline.disconnect();
+    deadline.setSingleShot(true);
+    QObject::connect(&deadline, &QTimer::timeout, [this] {
+        Recover(std::format("Lexurgy did not respond within {}", chr::duration_cast<chr::seconds>(deadline.intervalAsDuration())));
+    });
+
+    return {};
+}
+
+// =====================================================================
+//  Connexion
+// =====================================================================
+auto Connexion::Apply(
+    std::span<const QStringView> input,
+    QString changes,
+    const QString& start_after,
+    const QString& stop_before,
+    Callback cb
+) -> Result<RequestId> {
+    Resize();
+    auto id = NextId++;
+    changes = std::move(changes).trimmed();
+
+    // Collect the words.
+    std::vector<QStringView> words;
+    {
+        trace::Timer _{"split words"};
+        for (auto chunk : input)
+            for (auto w : chunk | vws::split('\n') | vws::filter([](auto&& w) { return not w.empty(); }))
+                words.emplace_back(w.begin(), w.end() - w.begin());
+    }
+
+    // Figure out which words we still need to send; send duplicates only
+    // once. Always send at least one request if there is nothing in the
+    // cache for these sound changes, even if there are no words, so errors
+    // in the sound changes are still reported. When comparing the native
+    // engine against Lexurgy, we want to compare everything, so ignore the
+    // cache in that case.
+    static const ResultCache::Table NoCache;
+    auto mode = GetNativeMode();
+    auto differential = mode == NativeEngineMode::Differential;
+    auto& cached = Cache.get(changes, start_after, stop_before);
+    const auto& table = differential or not Cache.is_enabled() ? NoCache : cached;
+    QSet<QStringView> seen;
+    std::vector<QStringView> missing;
+    {
+        trace::Timer _{"cache lookup"};
+        for (auto w : words) {
+            if (table.contains(w.toString()) or seen.contains(w)) continue;
+            seen.insert(w);
+            missing.push_back(w);
+        }
+    }
+
+    // Build the output from the cache once we have everything. Hold on
+    // to the table as it is now (this doesn’t copy anything) in case the
+    // cache is invalidated while we’re waiting for Lexurgy.
+    auto job = std::make_shared<Job>(std::vector<QString>{}, 1, std::move(cb));
+    auto ToStrings = vws::transform([](QStringView w) { return w.toString(); });
+    auto Assemble = [id, job, known = table, generation = Cache.current_generation(), run = trace::CurrentRun(),
+                     words = words | ToStrings | rgs::to<std::vector>(),
+                     missing = missing | ToStrings | rgs::to<std::vector>(),
+                     changes, start_after, stop_before](Result<QString> res) {
+        if (not job->callback) return;
+        trace::Scope scope{run};
+        if (auto c = GetIfExists()) c->jobs.erase(id);
+        auto callback = std::exchange(job->callback, {});
+        if (not res.has_value()) return callback(std::move(res));
+
+        // Lexurgy produces exactly one line per input word.
+        std::optional<trace::Timer> timer{std::in_place, "assemble output"};
+        auto results = QStringView{*res}.split('\n');
+        if (not results.empty() and results.back().isEmpty()) results.pop_back();
+        if (usz(results.size()) != missing.size()) return callback(Error(
+            "Lexurgy error: Expected {} words in response, but got {}",
+            missing.size(),
+            results.size()
+        ));
+
+        // Add new results to the cache, unless it has been invalidated since.
+        QHash<QString, QString> fresh;
+        for (auto [word, result] : vws::zip(missing, results)) fresh.insert(word, result.toString());
+        if (Cache.is_enabled() and Cache.current_generation() == generation) {
+            auto& t = Cache.get(changes, start_after, stop_before);
+            for (auto [word, result] : fresh.asKeyValueRange()) Cache.add(t, word, result);
+        }
+
+        // And stitch together the output.
+        QString joined;
+        for (const auto& w : words) {
+            auto it = fresh.find(w);
+            joined += it != fresh.end() ? *it : known.value(w);
+            joined += '\n';
+        }
+
+        timer.reset();
+        callback(std::move(joined));
+    };
+
+    jobs.emplace(id, job);
+
+    // If we have everything already, we’re done; don’t invoke the callback
+    // right away though since the caller may not be expecting that.
+    if (missing.empty() and not table.isEmpty()) {
+        QTimer::singleShot(0, [Assemble = std::move(Assemble)] mutable { Assemble(QString{}); });
+        return id;
+    }
+
+    // Use the native engine if it supports these sound changes; fall back
+    // to Lexurgy if it doesn’t.
+    Callback done = std::move(Assemble);
+    std::optional<trace::Timer> native_timer;
+    native_fallback = std::nullopt;
+    if (mode != NativeEngineMode::Disabled) native_timer.emplace("native engine");
+    auto engine = mode == NativeEngineMode::Disabled ? nullptr : GetNativeEngine(changes);
+    if (mode != NativeEngineMode::Disabled and not engine) native_fallback = native_error;
+    if (engine) {
+        auto native_result = engine->apply(missing, start_after, stop_before);
+        if (native_result and not differential) {
+            QTimer::singleShot(0, [done = std::move(done), out = std::move(*native_result)] mutable { done(std::move(out)); });
+            return id;
+        }
+
+        if (not native_result) {
+            native_fallback = std::move(native_result).error();
+        } else {
+            done = [done = std::move(done), native_output = std::move(*native_result),
+                    missing = missing | ToStrings | rgs::to<std::vector>()](Result<QString> res) {
+                if (not res.has_value()) return done(std::move(res));
+
+                // Report the first few words we disagree on.
+                auto a = QStringView{native_output}.split('\n');
+                auto b = QStringView{*res}.split('\n');
+                if (a.size() != b.size()) return done(Error(
+                    "Native engine error: Expected {} words, but Lexurgy returned {}",
+                    a.size(),
+                    b.size()
+                ));
+
+                QString mismatches;
+                usz count = 0;
+                for (auto [word, n, l] : vws::zip(missing, a, b)) {
+                    if (n == l or ++count > 10) continue;
+                    mismatches += QString{"\n    %1: native '%2', Lexurgy '%3'"}.arg(word, n, l);
+                }
+
+                if (count != 0) return done(Error(
+                    "Native engine error: Results differ from Lexurgy for {} words:{}",
+                    count,
+                    mismatches
+                ));
+
+                done(std::move(res));
+            };
+        }
+    }
+
+    native_timer.reset();
+    auto res = Dispatch(id, missing, changes, start_after, stop_before, std::move(done));
+    if (not res) {
+        jobs.erase(id);
+        return Error("{}", res.error());
+    }
+
+    return id;
+}
+
+void Connexion::Cancel(RequestId id) {
+    auto it = jobs.find(id);
+    if (it == jobs.end()) return;
+    it->second->callback = {};
+    jobs.erase(it);
+    for (auto& s : servers) s->Cancel(id);
+}
+
+void Connexion::Close() {
+    // We may be called from a callback that is invoked while one of our
+    // servers is processing a response, so don’t delete anything yet.
+    if (not Instance) return;
+    for (auto& s : Instance->servers) s->Close();
+    QTimer::singleShot(0, [dead = Instance.release()] { delete dead; });
+}
+
+auto Connexion::Dispatch(
+    RequestId id,
+    std::span<const QStringView> words,
+    const QString& changes,
+    const QString& start_after,
+    const QString& stop_before,
+    Callback cb
+) -> Result<> {
+    // Figure out how many chunks to split this into; always send at least
+    // one request, even if there are no words.
+    auto shards = std::clamp<usz>(words.size() / MinWordsPerShard, 1, servers.size());
+    auto job = std::make_shared<Job>(std::vector<QString>(shards), shards, std::move(cb));
+    auto chunk_size = (words.size() + shards - 1) / shards;
+
+    // Make sure all the servers we need are up before sending anything.
+    for (usz i = 0; i < shards; i++) Try(GetServer(i));
+    for (usz i = 0; i < shards; i++) {
+        auto begin = std::min(i * chunk_size, words.size());
+        auto end = std::min(begin + chunk_size, words.size());
+
+        // Once every chunk is done, merge them and report the result; if
+        // any of them fails, report that instead and drop the rest.
+        auto chunk = words.subspan(begin, end - begin);
+        auto sent = trace::Clock::now();
+        servers[i]->Apply(id, changes, chunk, start_after, stop_before, [id, i, job, sent, run = trace::CurrentRun()](Result<QString> res) {
+            trace::Scope scope{run};
+            trace::Record("lexurgy", sent);
+            if (not job->callback) return;
+            if (not res.has_value()) {
+                // Only drop the other chunks here; the job itself belongs
+                // to whoever gave us the callback.
+                auto callback = std::exchange(job->callback, {});
+                if (auto c = GetIfExists())
+                    for (auto& s : c->servers) s->Cancel(id);
+                return callback(std::move(res));
+            }
+
+            job->parts[i] = std::move(*res);
+            if (--job->remaining != 0) return;
+
+            QString joined;
+            {
+                trace::Timer _{"merge shards"};
+                usz size = 0;
+                for (auto& p : job->parts) size += usz(p.size());
+                joined.reserve(qsizetype(size));
+                for (auto& p : job->parts) joined += std::exchange(p, {});
+            }
+
+            std::exchange(job->callback, {})(std::move(joined));
+        });
+    }
 
-    sound_changes = std::move(tr);
     return {};
 }
+
+auto Connexion::Profile(
+    QStringView input,
+    QString changes,
+    std::vector<QString> rules,
+    ProfileCallback cb
+) -> Result<RequestId> {
+    Resize();
+    auto id = NextId++;
+    auto state = std::make_shared<ProfileState>();
+    state->rules = std::move(rules);
+    state->changes = std::move(changes).trimmed();
+    state->words = input.toString().split('\n', Qt::SkipEmptyParts);
+
+    // Every rule is sent as a separate request under the same id, one
+    // after the other, so the job only finishes once we’re through all
+    // of them; cancelling the job drops whichever one is pending.
+    auto job = std::make_shared<Job>(std::vector<QString>{}, 1, [state, cb = std::move(cb)](Result<QString> res) {
+        if (not res) return cb(Error("{}", res.error()));
+        cb(std::move(state->results));
+    });
+
+    jobs.emplace(id, job);
+    auto res = ProfileNext(id, job, state);
+    if (not res) {
+        jobs.erase(id);
+        return Error("{}", res.error());
+    }
+
+    return id;
+}
+
+auto Connexion::ProfileNext(
+    RequestId id,
+    std::shared_ptr<Job> job,
+    std::shared_ptr<ProfileState> state
+) -> Result<> {
+    // The first request applies everything up to the first rule; after
+    // that, each request applies exactly one rule. The last rule also
+    // includes the romaniser, if there is one.
+    auto i = state->results.size();
+    QString start = i == 0 ? "" : state->rules[i - 1];
+    QString stop = i < state->rules.size() ? state->rules[i] : "";
+    std::vector<QStringView> words{state->words.begin(), state->words.end()};
+
+    // Results of a profiling run are never cached, since that would
+    // defeat the purpose.
+    state->start = chr::steady_clock::now();
+    return Dispatch(id, words, state->changes, start, stop, [id, job, state, start](Result<QString> res) {
+        if (not job->callback) return;
+        auto elapsed = chr::steady_clock::now() - state->start;
+        auto Finish = [&](Result<QString> r) {
+            auto callback = std::exchange(job->callback, {});
+            if (auto c = GetIfExists()) c->jobs.erase(id);
+            callback(std::move(r));
+        };
+
+        if (not res) return Finish(std::move(res));
+        auto output = res->split('\n');
+        if (not output.empty() and output.back().isEmpty()) output.pop_back();
+        if (output.size() != state->words.size()) return Finish(Error(
+            "Lexurgy error: Expected {} words in response, but got {}",
+            state->words.size(),
+            output.size()
+        ));
+
+        usz changed = 0;
+        for (auto [a, b] : vws::zip(state->words, output))
+            if (a != b) changed++;
+
+        state->results.emplace_back(start, chr::duration_cast<chr::nanoseconds>(elapsed), changed);
+        state->words = std::move(output);
+
+        // Move on to the next rule, if there is one.
+        if (state->results.size() > state->rules.size()) return Finish(QString{});
+        auto c = GetIfExists();
+        if (not c) return Finish(Error("Lexurgy error: Connexion closed while profiling"));
+        if (auto next = c->ProfileNext(id, job, state); not next) Finish(Error("{}", next.error()));
+    });
+}
+
+auto Connexion::Prewarm(QStringView input, QString changes, Callback cb) -> Result<RequestId> {
+    Resize();
+    for (usz i = 0; i < servers.size(); i++) Try(GetServer(i));
+
+    // The JIT only kicks in once code has run for a bit, so apply the
+    // changes to some actual words rather than just loading them.
+    std::vector<QStringView> words;
+    for (auto w : input | vws::split('\n') | vws::filter([](auto&& w) { return not w.empty(); }) | vws::take(PrewarmWords))
+        words.emplace_back(w.begin(), w.end() - w.begin());
+
+    // We don’t care about the results, only about when every server is done.
+    auto id = NextId++;
+    auto job = std::make_shared<Job>(std::vector<QString>{}, servers.size(), std::move(cb));
+    changes = std::move(changes).trimmed();
+    jobs.emplace(id, job);
+    for (auto& s : servers) {
+        s->Apply(id, changes, words, {}, {}, [id, job](Result<QString> res) {
+            if (not job->callback) return;
+            if (res.has_value() and --job->remaining != 0) return;
+            auto callback = std::exchange(job->callback, {});
+            if (auto c = GetIfExists()) c->Cancel(id);
+            callback(res.has_value() ? Result<QString>{QString{}} : std::move(res));
+        });
+    }
+
+    return id;
+}
+
+auto Connexion::Get() -> Connexion& {
+    if (not Instance) Instance.reset(new Connexion);
+    return *Instance;
+}
+
+auto Connexion::GetNativeEngine(const QString& changes) -> const sca::Engine* {
+    if (changes != native_changes) {
+        native_changes = changes;
+        auto res = sca::Engine::Compile(changes);
+        if (res) native = std::move(*res);
+        else native = std::nullopt;
+        native_error = res ? std::string{} : std::move(res).error();
+    }
+
+    return native ? &*native : nullptr;
+}
+
+auto Connexion::GetNativeMode() -> NativeEngineMode {
+    if (NativeMode) return *NativeMode;
+    return *settings::NativeEngine ? NativeEngineMode::Enabled : NativeEngineMode::Disabled;
+}
+
+auto Connexion::GetServer(usz index) -> Result<Backend&> {
+    auto& s = servers[index];
+
+    // If the process has died, start a new one. The old one may still be
+    // in the middle of emitting a signal, so delete it later. Also replace
+    // servers that use the wrong backend, but only once they’re done.
+    if (s and (not s->Running() or (s->Idle() and s->InProcess() != UseInProcessBackend()))) {
+        s->Close();
+        QTimer::singleShot(0, [dead = s.release()] { delete dead; });
+    }
+
+    if (not s) {
+        std::unique_ptr<Backend> server;
+#ifdef SMYTH_LEXURGY_JNI
+        if (UseInProcessBackend()) server = CreateInProcessBackend();
+#endif
+        if (not server) server = std::make_unique<Server>();
+        Try(server->Start());
+        s = std::move(server);
+    }
+
+    return *s;
+}
+
+bool Connexion::UseInProcessBackend() {
+#ifdef SMYTH_LEXURGY_JNI
+    return *settings::LexurgyInProcess;
+#else
+    return false;
+#endif
+}
+
+void Connexion::Resize() {
+    auto count = ServerCount.value_or(usz(std::max(1, *settings::LexurgyServers)));
+
+    // Remove servers we no longer need, but only once they’re done with
+    // whatever they’re currently doing.
+    while (servers.size() > count and (not servers.back() or servers.back()->Idle())) {
+        if (auto& s = servers.back()) {
+            s->Close();
+            QTimer::singleShot(0, [dead = s.release()] { delete dead; });
+        }
+        servers.pop_back();
+    }
+
+    // Servers are started lazily, so just make room for them here.
+    if (servers.size() < count) servers.resize(count);
+}
 } // namespace
 
 // =====================================================================
@@ -151,11 +1240,70 @@ auto lexurgy::Apply(
     QStringView input,
     QString changes,
     const QString& start_after,
-    const QString& stop_before
-) -> Result<QString> {
-    return Try(Connexion::Get())->Apply(input, std::move(changes), start_after, stop_before);
+    const QString& stop_before,
+    Callback cb
+) -> Result<RequestId> {
+    return Connexion::Get().Apply({&input, 1}, std::move(changes), start_after, stop_before, std::move(cb));
+}
+
+auto lexurgy::Apply(
+    const QList<QString>& chunks,
+    QString changes,
+    const QString& start_after,
+    const QString& stop_before,
+    Callback cb
+) -> Result<RequestId> {
+    auto views = chunks | vws::transform([](const QString& c) { return QStringView{c}; }) | rgs::to<std::vector>();
+    return Connexion::Get().Apply(views, std::move(changes), start_after, stop_before, std::move(cb));
+}
+
+void lexurgy::Cancel(RequestId id) {
+    if (auto c = Connexion::GetIfExists()) c->Cancel(id);
+}
+
+auto lexurgy::Profile(
+    QStringView words,
+    QString changes,
+    std::vector<QString> rules,
+    ProfileCallback cb
+) -> Result<RequestId> {
+    return Connexion::Get().Profile(words, std::move(changes), std::move(rules), std::move(cb));
+}
+
+auto lexurgy::Prewarm(QStringView words, QString changes, Callback cb) -> Result<RequestId> {
+    return Connexion::Get().Prewarm(words, std::move(changes), std::move(cb));
+}
+
+void lexurgy::ClearCache() {
+    Cache.clear();
 }
 
 void lexurgy::Close() {
     Connexion::Close();
+    Cache.clear();
+}
+
+auto lexurgy::LoadCache(const QString& path) -> Result<> {
+    return Cache.load(path);
+}
+
+auto lexurgy::SaveCache(const QString& path) -> Result<> {
+    return Cache.save(path);
+}
+
+void lexurgy::SetCacheEnabled(bool enabled) {
+    Cache.enable(enabled);
+}
+
+auto lexurgy::NativeEngineFallbackReason() -> std::optional<std::string> {
+    if (auto c = Connexion::GetIfExists()) return c->native_fallback_reason();
+    return std::nullopt;
+}
+
+void lexurgy::SetNativeEngineMode(NativeEngineMode mode) {
+    Connexion::NativeMode = mode;
+}
+
+void lexurgy::SetServerCount(usz count) {
+    Connexion::ServerCount = std::max<usz>(count, 1);
 }
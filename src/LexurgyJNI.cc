@@ -0,0 +1,441 @@
+#ifdef SMYTH_LEXURGY_JNI
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <jni.h>
+#include <mutex>
+#include <QCoreApplication>
+#include <thread>
+#include <UI/LexurgyBackend.hh>
+
+using namespace smyth;
+using namespace smyth::lexurgy;
+using namespace smyth::lexurgy::detail;
+
+namespace {
+/// The JVM and everything we need from it.
+///
+/// There can only be one JVM per process, and it can’t be created again
+/// once it has been destroyed, so we start it the first time it is needed
+/// and keep it around until Smyth exits.
+struct JVM {
+    JavaVM* vm;
+
+    /// com.meamoria.lexurgy.cli.ApplicationKt; this is where the functions
+    /// that ‘lexurgy server’ uses to load sound changes live.
+    jclass application;
+    jmethodID sound_changer_from_string;
+
+    /// com.meamoria.lexurgy.sc.SoundChanger; ‘change’ has a number of
+    /// optional parameters, so we call the synthetic method that Kotlin
+    /// generates for default arguments instead of passing them ourselves.
+    jclass sound_changer;
+    jmethodID change_default;
+
+    /// Everything else.
+    jclass array_list;
+    jmethodID array_list_init;
+    jmethodID list_add;
+    jmethodID list_get;
+    jmethodID list_size;
+    jmethodID throwable_get_message;
+    jmethodID object_to_string;
+
+    /// Get the JVM, starting it if need be. Must be called on the
+    /// GUI thread.
+    static auto Get() -> Result<JVM&>;
+
+private:
+    static auto Create() -> Result<JVM>;
+};
+
+/// Bits of the ‘change’ arguments that should use their default value,
+/// i.e. everything but the words and the rules to start at and stop before.
+constexpr jint ChangeDefaultMask = 0x1F8;
+
+/// Get a global reference to a class.
+auto FindClass(JNIEnv* env, const char* name) -> Result<jclass> {
+    auto local = env->FindClass(name);
+    if (not local) {
+        env->ExceptionClear();
+        return Error("Lexurgy error: Could not find class '{}'", name);
+    }
+
+    auto global = jclass(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+    return global;
+}
+
+/// Look up a method.
+auto FindMethod(JNIEnv* env, jclass cls, const char* name, const char* sig, bool is_static = false) -> Result<jmethodID> {
+    auto m = is_static ? env->GetStaticMethodID(cls, name, sig) : env->GetMethodID(cls, name, sig);
+    if (not m) {
+        env->ExceptionClear();
+        return Error("Lexurgy error: Could not find method '{}{}'", name, sig);
+    }
+    return m;
+}
+
+/// Convert a Java string to a QString. Java strings are UTF-16 as well,
+/// so this is just a copy.
+void AppendString(JNIEnv* env, QString& out, jstring str) {
+    auto len = env->GetStringLength(str);
+    auto old = out.size();
+    out.resize(old + len);
+    env->GetStringRegion(str, 0, len, reinterpret_cast<jchar*>(out.data() + old));
+}
+
+/// Convert a QString to a Java string; returns null for an empty string.
+auto ToJava(JNIEnv* env, const QString& str) -> jstring {
+    if (str.isEmpty()) return nullptr;
+    return env->NewString(reinterpret_cast<const jchar*>(str.utf16()), jsize(str.size()));
+}
+
+/// Turn a pending Java exception into an error.
+auto CheckException(JNIEnv* env, const JVM& jvm) -> Result<> {
+    auto ex = env->ExceptionOccurred();
+    if (not ex) return {};
+    env->ExceptionClear();
+
+    // Prefer the message, which is what ‘lexurgy server’ reports; fall
+    // back to the name of the exception if there is none.
+    auto msg = jstring(env->CallObjectMethod(ex, jvm.throwable_get_message));
+    if (env->ExceptionCheck()) env->ExceptionClear();
+    if (not msg) msg = jstring(env->CallObjectMethod(ex, jvm.object_to_string));
+    if (env->ExceptionCheck()) env->ExceptionClear();
+
+    QString text;
+    if (msg) AppendString(env, text, msg);
+    if (text.isEmpty()) text = "Unknown error";
+    return Error("Lexurgy error: {}", text);
+}
+
+auto JVM::Create() -> Result<JVM> {
+    // Keep the JVM from installing handlers for SIGINT etc. since those
+    // belong to us; Lexurgy doesn’t need them anyway.
+    std::string classpath = "-Djava.class.path=" LEXURGY_CLASSPATH;
+    std::string reduce_signals = "-Xrs";
+    std::array options{
+        JavaVMOption{.optionString = classpath.data(), .extraInfo = nullptr},
+        JavaVMOption{.optionString = reduce_signals.data(), .extraInfo = nullptr},
+    };
+
+    JavaVMInitArgs args{
+        .version = JNI_VERSION_10,
+        .nOptions = jint(options.size()),
+        .options = options.data(),
+        .ignoreUnrecognized = JNI_FALSE,
+    };
+
+    JVM jvm{};
+    JNIEnv* env{};
+    if (JNI_CreateJavaVM(&jvm.vm, reinterpret_cast<void**>(&env), &args) != JNI_OK)
+        return Error("Lexurgy error: Failed to start the JVM");
+
+    jvm.application = Try(FindClass(env, "com/meamoria/lexurgy/cli/ApplicationKt"));
+    jvm.sound_changer = Try(FindClass(env, "com/meamoria/lexurgy/sc/SoundChanger"));
+    jvm.array_list = Try(FindClass(env, "java/util/ArrayList"));
+    auto list = Try(FindClass(env, "java/util/List"));
+    auto throwable = Try(FindClass(env, "java/lang/Throwable"));
+    auto object = Try(FindClass(env, "java/lang/Object"));
+
+    jvm.sound_changer_from_string = Try(FindMethod(
+        env,
+        jvm.application,
+        "soundChangerFromString",
+        "(Ljava/lang/String;)Lcom/meamoria/lexurgy/sc/SoundChanger;",
+        true
+    ));
+
+    jvm.change_default = Try(FindMethod(
+        env,
+        jvm.sound_changer,
+        "change$default",
+        "(Lcom/meamoria/lexurgy/sc/SoundChanger;"
+        "Ljava/util/List;"                  // words
+        "Ljava/lang/String;"                // startAt
+        "Ljava/lang/String;"                // stopBefore
+        "Ljava/util/List;"                  // debugWords
+        "Z"                                 // romanize
+        "Lkotlin/jvm/functions/Function1;"  // debug
+        "Lkotlin/jvm/functions/Function1;"  // trace
+        "Ljava/lang/Double;"                // ruleTimeoutSeconds
+        "Ljava/lang/Double;"                // totalTimeoutSeconds
+        "ILjava/lang/Object;)Ljava/util/List;",
+        true
+    ));
+
+    jvm.array_list_init = Try(FindMethod(env, jvm.array_list, "<init>", "(I)V"));
+    jvm.list_add = Try(FindMethod(env, list, "add", "(Ljava/lang/Object;)Z"));
+    jvm.list_get = Try(FindMethod(env, list, "get", "(I)Ljava/lang/Object;"));
+    jvm.list_size = Try(FindMethod(env, list, "size", "()I"));
+    jvm.throwable_get_message = Try(FindMethod(env, throwable, "getMessage", "()Ljava/lang/String;"));
+    jvm.object_to_string = Try(FindMethod(env, object, "toString", "()Ljava/lang/String;"));
+    return jvm;
+}
+
+auto JVM::Get() -> Result<JVM&> {
+    // If we fail to start the JVM, we can’t try again, so remember
+    // the error.
+    static std::optional<Result<JVM>> Instance;
+    if (not Instance) Instance = Create();
+    if (not Instance->has_value()) return Error("{}", Instance->error());
+    return Instance->value();
+}
+
+/// Lexurgy running on a thread inside Smyth.
+///
+/// Each backend has its own worker thread and its own instance of the
+/// sound changer, so running several of them in parallel works the same
+/// way as running several Lexurgy processes.
+class InProcessBackend final : public Backend {
+    /// A request to apply sound changes.
+    struct Request {
+        RequestId id;
+        QString changes;
+        QStringList words;
+        QString start_at;
+        QString stop_before;
+
+        /// Only accessed on the GUI thread.
+        Callback callback;
+
+        /// Set if the request was cancelled; the worker checks this
+        /// before it starts working on a request.
+        std::atomic<bool> cancelled = false;
+    };
+
+    /// State shared with the worker thread.
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::shared_ptr<Request>> queue;
+        bool stop = false;
+
+        /// Requests that have not been reported yet, in order. This and
+        /// ‘closed’ are only accessed on the GUI thread.
+        std::deque<std::shared_ptr<Request>> pending;
+        bool closed = false;
+    };
+
+    std::shared_ptr<State> state = std::make_shared<State>();
+    bool started = false;
+
+public:
+    InProcessBackend() = default;
+    ~InProcessBackend() override { Close(); }
+
+    void Apply(
+        RequestId id,
+        QString changes,
+        std::span<const QStringView> words,
+        QStringView start_at,
+        QStringView stop_before,
+        Callback cb
+    ) override;
+
+    void Cancel(RequestId id) override;
+    void Close() override;
+    bool Idle() const override { return state->pending.empty(); }
+    bool InProcess() const override { return true; }
+    bool Running() const override { return started and not state->closed; }
+    auto Start() -> Result<> override;
+
+private:
+    /// Apply sound changes on the worker thread.
+    static auto Process(
+        JNIEnv* env,
+        const JVM& jvm,
+        const Request& r,
+        jobject& changer,
+        std::optional<QString>& loaded
+    ) -> Result<QString>;
+
+    /// Process requests until we’re told to stop.
+    static void Work(std::shared_ptr<State> state, const JVM& jvm);
+};
+
+void InProcessBackend::Apply(
+    RequestId id,
+    QString changes,
+    std::span<const QStringView> words,
+    QStringView start_at,
+    QStringView stop_before,
+    Callback cb
+) {
+    // Copy the words since we don’t own them; this is still much
+    // cheaper than serialising them.
+    auto r = std::make_shared<Request>();
+    r->id = id;
+    r->changes = std::move(changes);
+    r->words.reserve(qsizetype(words.size()));
+    for (auto w : words) r->words.push_back(w.toString());
+    r->start_at = start_at.toString();
+    r->stop_before = stop_before.toString();
+    r->callback = std::move(cb);
+    state->pending.push_back(r);
+
+    {
+        std::unique_lock _{state->mutex};
+        state->queue.push_back(std::move(r));
+    }
+
+    state->cv.notify_one();
+}
+
+void InProcessBackend::Cancel(RequestId id) {
+    for (auto& r : state->pending)
+        if (r->id == id)
+            r->cancelled = true;
+}
+
+void InProcessBackend::Close() {
+    if (state->closed) return;
+    state->closed = true;
+    for (auto& r : state->pending) r->cancelled = true;
+    state->pending.clear();
+
+    // We can’t interrupt Lexurgy, so don’t wait for the worker; it
+    // exits on its own once it’s done with whatever it’s doing.
+    {
+        std::unique_lock _{state->mutex};
+        state->stop = true;
+        state->queue.clear();
+    }
+
+    state->cv.notify_one();
+}
+
+auto InProcessBackend::Process(
+    JNIEnv* env,
+    const JVM& jvm,
+    const Request& r,
+    jobject& changer,
+    std::optional<QString>& loaded
+) -> Result<QString> {
+    // Load the sound changes if they’re different from last time.
+    if (loaded != r.changes) {
+        if (changer) env->DeleteGlobalRef(changer);
+        changer = nullptr;
+        loaded = std::nullopt;
+
+        auto changes = ToJava(env, r.changes);
+        auto local = env->CallStaticObjectMethod(jvm.application, jvm.sound_changer_from_string, changes);
+        if (changes) env->DeleteLocalRef(changes);
+        Try(CheckException(env, jvm));
+        changer = env->NewGlobalRef(local);
+        env->DeleteLocalRef(local);
+        loaded = r.changes;
+    }
+
+    // Pass the words as a list of Java strings.
+    auto words = env->NewObject(jvm.array_list, jvm.array_list_init, jint(r.words.size()));
+    Try(CheckException(env, jvm));
+    for (auto& w : r.words) {
+        auto s = ToJava(env, w);
+        if (not s) s = env->NewString(nullptr, 0);
+        env->CallBooleanMethod(words, jvm.list_add, s);
+        env->DeleteLocalRef(s);
+        Try(CheckException(env, jvm));
+    }
+
+    auto start_at = ToJava(env, r.start_at);
+    auto stop_before = ToJava(env, r.stop_before);
+    auto result = env->CallStaticObjectMethod(
+        jvm.sound_changer,
+        jvm.change_default,
+        changer,
+        words,
+        start_at,
+        stop_before,
+        nullptr,
+        JNI_TRUE,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        ChangeDefaultMask,
+        nullptr
+    );
+
+    Try(CheckException(env, jvm));
+
+    // Join the results with newlines, like the output of the server.
+    QString out;
+    auto size = env->CallIntMethod(result, jvm.list_size);
+    Try(CheckException(env, jvm));
+    out.reserve(qsizetype(size) * 8);
+    for (jint i = 0; i < size; i++) {
+        auto s = jstring(env->CallObjectMethod(result, jvm.list_get, i));
+        Try(CheckException(env, jvm));
+        if (s) AppendString(env, out, s);
+        out += '\n';
+        env->DeleteLocalRef(s);
+    }
+
+    return out;
+}
+
+auto InProcessBackend::Start() -> Result<> {
+    if (started) return {};
+    auto& jvm = Try(JVM::Get());
+    std::thread{Work, state, std::cref(jvm)}.detach();
+    started = true;
+    return {};
+}
+
+void InProcessBackend::Work(std::shared_ptr<State> state, const JVM& jvm) {
+    // Daemon threads don’t keep the JVM alive.
+    JNIEnv* env{};
+    auto attached = jvm.vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(&env), nullptr) == JNI_OK;
+
+    jobject changer = nullptr;
+    std::optional<QString> loaded;
+    for (;;) {
+        std::shared_ptr<Request> r;
+        {
+            std::unique_lock lock{state->mutex};
+            state->cv.wait(lock, [&] { return state->stop or not state->queue.empty(); });
+            if (state->stop) break;
+            r = std::move(state->queue.front());
+            state->queue.pop_front();
+        }
+
+        // Free all local references created while processing this.
+        Result<QString> res = QString{};
+        if (not attached) {
+            res = Error("Lexurgy error: Failed to attach to the JVM");
+        } else if (not r->cancelled) {
+            if (env->PushLocalFrame(64) == 0) {
+                res = Process(env, jvm, *r, changer, loaded);
+                env->PopLocalFrame(nullptr);
+            } else {
+                env->ExceptionClear();
+                res = Error("Lexurgy error: Out of memory");
+            }
+        }
+
+        // Report the result on the GUI thread. Requests are processed in
+        // order, so the one we’re reporting is always the first one that
+        // is still pending, unless we’ve been closed in the meantime.
+        QMetaObject::invokeMethod(
+            QCoreApplication::instance(),
+            [state, r, res = std::move(res)] mutable {
+                if (state->closed) return;
+                Assert(not state->pending.empty() and state->pending.front() == r, "Out-of-order response");
+                state->pending.pop_front();
+                if (not r->cancelled) std::exchange(r->callback, {})(std::move(res));
+            },
+            Qt::QueuedConnection
+        );
+    }
+
+    if (changer) env->DeleteGlobalRef(changer);
+    if (attached) jvm.vm->DetachCurrentThread();
+}
+} // namespace
+
+auto detail::CreateInProcessBackend() -> std::unique_ptr<Backend> {
+    return std::make_unique<InProcessBackend>();
+}
+#endif // SMYTH_LEXURGY_JNI
@@ -0,0 +1,266 @@
+#include <UI/LexurgyProtocol.hh>
+
+namespace smyth::lexurgy::detail {
+void ResponseReader::feed(QByteArrayView data) {
+    for (usz i = 0; i < usz(data.size()); i++) {
+        char c = data[qsizetype(i)];
+
+        // Skip the rest of a response that we’ve given up on.
+        if (discard) {
+            if (c == '\n') discard = false;
+            continue;
+        }
+
+        // Inside of a string, only quotes and backslashes are special; we
+        // only care about the contents of words and top-level keys, so
+        // copy everything else into the skeleton.
+        if (in_string) {
+            auto in_word = depth == 2 and in_words;
+            if (escape) escape = false;
+            else if (c == '\\') escape = true;
+            else if (c == '"') {
+                in_string = false;
+                if (not in_word) {
+                    skeleton += c;
+                    continue;
+                }
+
+                // Don’t keep the rest of the line around if the word is
+                // invalid; whatever the response was, it’s unusable now.
+                if (auto res = AppendDecoded(words, str); not res) {
+                    complete.push_back(Error("{}", res.error()));
+                    reset();
+                    discard = true;
+                    continue;
+                }
+
+                words += '\n';
+                continue;
+            }
+
+            if (in_word or (depth == 1 and expect_key)) str += c;
+            if (not in_word) skeleton += c;
+            continue;
+        }
+
+        switch (c) {
+            // A newline outside a string terminates the response.
+            case '\n':
+                Finish();
+                continue;
+
+            // Whitespace is irrelevant.
+            case ' ':
+            case '\t':
+            case '\r':
+                continue;
+
+            case '"':
+                in_string = true;
+                str.clear();
+                if (depth == 2 and in_words) continue;
+                break;
+
+            case '{':
+            case '[':
+                depth++;
+                if (depth == 1) expect_key = true;
+                if (depth == 2 and c == '[' and str == "words") in_words = true;
+                break;
+
+            case '}':
+            case ']':
+                if (depth == 2 and in_words) in_words = false;
+                depth--;
+                break;
+
+            case ':':
+                if (depth == 1) expect_key = false;
+                break;
+
+            // The separators between words are dropped along with them.
+            case ',':
+                if (depth == 1) expect_key = true;
+                if (depth == 2 and in_words) continue;
+                break;
+
+            default:
+                break;
+        }
+
+        skeleton += c;
+    }
+}
+
+auto ResponseReader::AppendDecoded(QString& out, std::string_view raw) -> Result<> {
+    static constexpr auto Hex = [](char c) -> int {
+        if (c >= '0' and c <= '9') return c - '0';
+        if (c >= 'a' and c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' and c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    // Copy everything between escape sequences as is; JSON escapes are
+    // UTF-16 code units, so we can append those directly as well, even
+    // if they’re surrogates.
+    for (;;) {
+        auto bs = raw.find('\\');
+        auto run = raw.substr(0, bs);
+        if (not run.empty()) out += QUtf8StringView{run.data(), qsizetype(run.size())};
+        if (bs == std::string_view::npos) return {};
+        raw.remove_prefix(bs + 1);
+        if (raw.empty()) return Error("Lexurgy error: Invalid escape sequence in response");
+        char c = raw.front();
+        raw.remove_prefix(1);
+        switch (c) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                char16_t unit = 0;
+                if (raw.size() < 4) return Error("Lexurgy error: Invalid escape sequence in response");
+                for (char h : raw.substr(0, 4)) {
+                    auto v = Hex(h);
+                    if (v < 0) return Error("Lexurgy error: Invalid escape sequence in response");
+                    unit = char16_t(unit << 4 | v);
+                }
+
+                raw.remove_prefix(4);
+                out += QChar(unit);
+            } break;
+            default: return Error("Lexurgy error: Invalid escape sequence in response");
+        }
+    }
+}
+
+void ResponseReader::Finish() {
+    // Ignore blank lines.
+    if (skeleton.empty() and depth == 0) return;
+    if (depth != 0 or in_string) {
+        complete.push_back(Error("Lexurgy error: Malformed response"));
+        reset();
+        return;
+    }
+
+    auto res = [&] -> Result<Response> {
+        auto header = Try(json_utils::Parse(skeleton));
+        return Response{std::move(header), std::move(words)};
+    }();
+
+    complete.push_back(std::move(res));
+    reset();
+}
+
+void ResponseReader::reset() {
+    skeleton.clear();
+    words.clear();
+    str.clear();
+    depth = 0;
+    in_string = false;
+    escape = false;
+    expect_key = false;
+    in_words = false;
+    discard = false;
+}
+
+auto ResponseReader::take() -> std::optional<Result<Response>> {
+    if (complete.empty()) return std::nullopt;
+    auto r = std::move(complete.front());
+    complete.pop_front();
+    return r;
+}
+
+void AppendJsonString(std::string& out, QStringView str) {
+    static constexpr std::string_view HexDigits = "0123456789abcdef";
+    out += '"';
+    for (qsizetype i = 0; i < str.size(); i++) {
+        char32_t c = str[i].unicode();
+
+        // Combine surrogate pairs.
+        if (QChar::isHighSurrogate(c) and i + 1 < str.size() and str[i + 1].isLowSurrogate()) {
+            c = QChar::surrogateToUcs4(char16_t(c), str[++i].unicode());
+        } else if (QChar::isSurrogate(c)) {
+            c = QChar::ReplacementCharacter;
+        }
+
+        if (c < 0x80) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (c >= 0x20) {
+                        out += char(c);
+                    } else {
+                        out += "\\u00";
+                        out += HexDigits[c >> 4];
+                        out += HexDigits[c & 0xF];
+                    }
+            }
+        } else if (c < 0x800) {
+            out += char(0xC0 | c >> 6);
+            out += char(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out += char(0xE0 | c >> 12);
+            out += char(0x80 | (c >> 6 & 0x3F));
+            out += char(0x80 | (c & 0x3F));
+        } else {
+            out += char(0xF0 | c >> 18);
+            out += char(0x80 | (c >> 12 & 0x3F));
+            out += char(0x80 | (c >> 6 & 0x3F));
+            out += char(0x80 | (c & 0x3F));
+        }
+    }
+    out += '"';
+}
+
+auto EncodeApply(
+    std::span<const QStringView> words,
+    QStringView start_at,
+    QStringView stop_before
+) -> std::string {
+    // Most words are short and mostly ASCII, so this is usually enough to
+    // avoid reallocating; each word needs at least 3 extra bytes for the
+    // quotes and comma.
+    usz size = 64 + usz(start_at.size() + stop_before.size());
+    for (auto w : words) size += usz(w.size()) * 2 + 3;
+
+    std::string req;
+    req.reserve(size);
+    req += R"({"type":"apply","words":[)";
+    for (auto [i, w] : words | vws::enumerate) {
+        if (i != 0) req += ',';
+        AppendJsonString(req, w);
+    }
+
+    req += ']';
+    if (not start_at.empty()) {
+        req += R"(,"startAt":)";
+        AppendJsonString(req, start_at);
+    }
+
+    if (not stop_before.empty()) {
+        req += R"(,"stopBefore":)";
+        AppendJsonString(req, stop_before);
+    }
+
+    req += '}';
+    return req;
+}
+
+auto EncodeLoadChanges(QStringView changes) -> std::string {
+    std::string req;
+    req.reserve(usz(changes.size()) + usz(changes.size()) / 8 + 64);
+    req += R"({"type":"load_string","changes":)";
+    AppendJsonString(req, changes);
+    req += '}';
+    return req;
+}
+} // namespace smyth::lexurgy::detail
@@ -1,5 +1,6 @@
 #include <print>
 #include <QApplication>
+#include <UI/Batch.hh>
 #include <UI/MainWindow.hh>
 #include <UI/Smyth.hh>
 
@@ -19,11 +20,29 @@ void FailureHandler(const libassert::assertion_info& info) {
     box.exec();
 }
 
-int main(int argc, char* argv[]) {
-    QApplication app(argc, argv);
+void SetApplicationInfo() {
     QCoreApplication::setOrganizationName("Smyth");
     QCoreApplication::setApplicationName("Smyth");
     QCoreApplication::setOrganizationDomain("nguh.org");
+}
+
+int main(int argc, char* argv[]) {
+    // Headless mode; don’t create a QApplication here since that requires
+    // a display.
+    if (argc > 1 and std::string_view{argv[1]} == "apply") {
+        QCoreApplication app(argc, argv);
+        SetApplicationInfo();
+        return smyth::ui::batch::Apply(app.arguments().mid(1));
+    }
+
+    if (argc > 1 and std::string_view{argv[1]} == "bench") {
+        QCoreApplication app(argc, argv);
+        SetApplicationInfo();
+        return smyth::ui::batch::Bench(app.arguments().mid(1));
+    }
+
+    QApplication app(argc, argv);
+    SetApplicationInfo();
     libassert::set_failure_handler(FailureHandler);
     smyth::ui::InitialiseSmyth();
     return app.exec();
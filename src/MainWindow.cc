@@ -1,11 +1,17 @@
 #include <base/Text.hh>
 #include <print>
 #include <QFileDialog>
-#include <QJSEngine>
+#include <QLabel>
 #include <QShortcut>
+#include <Smyth/Unicode.hh>
+#include <Smyth/WordGenerator.hh>
+#include <Smyth/WordIndex.hh>
 #include <UI/Lexurgy.hh>
 #include <UI/MainWindow.hh>
+#include <UI/ProfileDialog.hh>
 #include <UI/SettingsDialog.hh>
+#include <UI/SmythOutputView.hh>
+#include <UI/SmythWordList.hh>
 #include <UI/TextPreviewDialog.hh>
 #include <ui_MainWindow.h>
 
@@ -14,6 +20,28 @@ using namespace smyth::ui;
 
 MainWindow* MainWindow::Instance;
 
+// ====================================================================
+//  Helpers
+// ====================================================================
+/// Normalise text using the normalisation form selected in a combo box.
+static auto Norm(QComboBox* cbox, QString plain) -> Result<QString> {
+    const auto norm = [cbox] {
+        switch (cbox->currentIndex()) {
+            default: return text::NormalisationForm::None;
+            case 1: return text::NormalisationForm::NFC;
+            case 2: return text::NormalisationForm::NFD;
+        }
+    }();
+
+    Try(Normalise(plain, norm));
+    return plain;
+}
+
+/// Get the text of the entry in the dedup combo box for a column.
+static auto DedupLabel(const QString& column) -> QString {
+    return QString::fromStdString(std::format("Not in ‘{}’", column.toStdString()));
+}
+
 // ====================================================================
 //  Initialisation
 // ====================================================================
@@ -26,6 +54,17 @@ MainWindow::MainWindow()
     ui->setupUi(this);
     setWindowTitle("Smyth");
 
+    // Show what Lexurgy is doing in the background without getting in
+    // the way of the regular status bar messages.
+    lexurgy_status = new QLabel(this);
+    lexurgy_status->setVisible(false);
+    ui->statusbar->addPermanentWidget(lexurgy_status);
+
+    // Show how long the last apply took; the tooltip has the details.
+    timing_status = new QLabel(this);
+    timing_status->setVisible(false);
+    ui->statusbar->addPermanentWidget(timing_status);
+
     // Initialise shortcuts.
     auto save = new QShortcut(QKeySequence::Save, this);
     auto open = new QShortcut(QKeySequence::Open, this);
@@ -36,6 +75,31 @@ MainWindow::MainWindow()
 
     // Initialise other signals.
     connect(ui->char_map, &SmythCharacterMap::selected, this, &MainWindow::char_map_update_selection);
+
+    // Apply sound changes automatically once the user stops typing for
+    // a bit if live mode is enabled.
+    live_apply_timer = new QTimer(this);
+    live_apply_timer->setSingleShot(true);
+    live_apply_timer->setInterval(LiveApplyDelay);
+    connect(live_apply_timer, &QTimer::timeout, this, &MainWindow::apply_sound_changes_live);
+    connect(ui->input, &QPlainTextEdit::textChanged, this, &MainWindow::schedule_live_apply);
+    connect(ui->changes, &QPlainTextEdit::textChanged, this, &MainWindow::schedule_live_apply);
+    connect(ui->sca_chbox_live, &QCheckBox::toggled, this, &MainWindow::schedule_live_apply);
+
+    // Keep track of the rules in the sound changes as they’re edited.
+    outline = new RuleOutline(ui->changes->document(), this);
+    connect(outline, &RuleOutline::namesChanged, this, &MainWindow::update_rule_names);
+    connect(ui->sca_chbox_enable_javascript, &QCheckBox::toggled, this, &MainWindow::update_rule_names);
+    connect(ui->sca_cbox_goto_rule, &QComboBox::activated, this, &MainWindow::goto_rule);
+
+    // Keep the dictionary columns that generated words can be checked
+    // against in sync with the dictionary.
+    auto dict = ui->dictionary_table->model();
+    connect(dict, &QAbstractItemModel::columnsInserted, this, &MainWindow::update_wordgen_dedup_columns);
+    connect(dict, &QAbstractItemModel::columnsRemoved, this, &MainWindow::update_wordgen_dedup_columns);
+    connect(dict, &QAbstractItemModel::columnsMoved, this, &MainWindow::update_wordgen_dedup_columns);
+    connect(dict, &QAbstractItemModel::headerDataChanged, this, &MainWindow::update_wordgen_dedup_columns);
+    update_wordgen_dedup_columns();
 }
 
 void MainWindow::Init() {
@@ -69,7 +133,9 @@ void MainWindow::Persist() {
         QApplication::processEvents();
     }>(main_store, "window.size", this, 1);
 
-    // Initialise persistent settings.
+    // Initialise persistent settings. Word lists can get very long, so
+    // don’t put all of the input in the editor if it is huge.
+    ui->input->enableLargeDocumentMode();
     ui->input->persist(main_store, "input");
     ui->changes->persist(main_store, "changes");
     ui->output->persist(main_store, "output");
@@ -86,6 +152,7 @@ void MainWindow::Persist() {
     PersistDynCBox(sca, "cbox.stop.before", ui->sca_cbox_stop_before);
     PersistChBox(sca, "chbox.details", ui->sca_chbox_details);
     PersistChBox(sca, "chbox.enable.js", ui->sca_chbox_enable_javascript);
+    PersistChBox(sca, "chbox.live", ui->sca_chbox_live);
 
     PersistentStore& notes_store = PersistentStore::Create("notes", main_store);
     ui->notes_file_list->persist(notes_store);
@@ -98,6 +165,11 @@ void MainWindow::Persist() {
     ui->wordgen_classes_input->persist(wordgen_store, "classes");
     ui->wordgen_output->persist(wordgen_store, "output");
     Persist<&QLineEdit::text, &QLineEdit::setText>(wordgen_store, "phono", ui->wordgen_input_phono);
+    Persist<&QSpinBox::value, &QSpinBox::setValue>(wordgen_store, "count", ui->wordgen_count);
+    PersistChBox(wordgen_store, "chbox.uniform", ui->wordgen_chbox_uniform);
+    PersistDynCBox(wordgen_store, "cbox.dedup", ui->wordgen_cbox_dedup);
+    Persist<&QLineEdit::text, &QLineEdit::setText>(wordgen_store, "seed", ui->wordgen_seed);
+    Persist<&QLineEdit::placeholderText, &QLineEdit::setPlaceholderText>(wordgen_store, "seed.last", ui->wordgen_seed);
     PersistState(wordgen_store, "splitter", ui->wordgen_splitter);
 
     // Hide the details panels if the checkbox is unchecked.
@@ -111,11 +183,11 @@ void MainWindow::Persist() {
 
     // Init user settings.
     settings::SerifFont.subscribe(ui->input, &SmythPlainTextEdit::setFont);
-    settings::SerifFont.subscribe(ui->output, &SmythPlainTextEdit::setFont);
+    settings::SerifFont.subscribe(ui->output, &SmythOutputView::setFont);
     settings::SerifFont.subscribe(ui->char_map, &SmythCharacterMap::setFont);
     settings::SerifFont.subscribe(ui->char_map_details_panel, &SmythRichTextEdit::setFont);
     settings::SerifFont.subscribe(ui->wordgen_classes_input, &SmythPlainTextEdit::setFont);
-    settings::SerifFont.subscribe(ui->wordgen_output, &SmythPlainTextEdit::setFont);
+    settings::SerifFont.subscribe(ui->wordgen_output, &SmythWordList::setFont);
     settings::SerifFont.subscribe(ui->wordgen_input_phono, &QLineEdit::setFont);
     settings::MonoFont.subscribe(ui->changes, &SmythPlainTextEdit::setFont);
     settings::SansFont.subscribe(ui->notes_text_box, &SmythRichTextEdit::setFont);
@@ -128,6 +200,15 @@ void MainWindow::Persist() {
 /// Needs destructor that isn’t visible in the header.
 MainWindow::~MainWindow() noexcept = default;
 
+void MainWindow::CancelPendingRequests() {
+    auto& w = *Instance;
+    if (w.pending_apply) lexurgy::Cancel(std::exchange(w.pending_apply, 0));
+    if (w.pending_prewarm) lexurgy::Cancel(std::exchange(w.pending_prewarm, 0));
+    if (w.pending_profile) lexurgy::Cancel(std::exchange(w.pending_profile, 0));
+    w.lexurgy_status->setVisible(false);
+    w.ui->statusbar->clearMessage();
+}
+
 auto MainWindow::GetNotesTabTextBox() -> SmythPlainTextEdit* {
     return Instance->ui->notes_text_box;
 }
@@ -140,11 +221,46 @@ auto MainWindow::Prompt(
     return QMessageBox::question(Instance, title, message, buttons);
 }
 
+void MainWindow::PrewarmLexurgy() {
+    auto Prewarm = [&] -> Result<> {
+        auto& w = *Instance;
+        if (w.pending_prewarm) lexurgy::Cancel(std::exchange(w.pending_prewarm, 0));
+
+        // Don’t bother if there is nothing to apply.
+        auto changes = Try(w.GetSoundChanges());
+        if (changes.trimmed().isEmpty()) return {};
+        // Prewarming only uses the first few words, so don’t bother
+        // copying a huge input in its entirety.
+        auto input = Try(Norm(w.ui->sca_cbox_input_norm, w.ui->input->chunks().value(0)));
+        w.pending_prewarm = Try(lexurgy::Prewarm(input, std::move(changes), [&w](Result<QString> res) {
+            w.pending_prewarm = 0;
+            w.lexurgy_status->setVisible(false);
+
+            // Don’t bother the user with errors here; they’ll see them
+            // again once they actually apply the sound changes.
+            if (not res) std::println(stderr, "Failed to prewarm Lexurgy: {}", res.error());
+        }));
+
+        w.lexurgy_status->setText("Starting Lexurgy...");
+        w.lexurgy_status->setVisible(true);
+        return {};
+    };
+
+    auto res = Prewarm();
+    if (not res) std::println(stderr, "Failed to prewarm Lexurgy: {}", res.error());
+}
+
 void MainWindow::Reset() {
     Instance->ui->dictionary_table->reset_dictionary();
+    ResetJavaScript();
+    CancelPendingRequests();
     SetWindowPath("");
 }
 
+void MainWindow::ResetJavaScript() {
+    Instance->js.reset();
+}
+
 void MainWindow::SetWindowPath(QString path) {
     if (path.isEmpty()) {
         Instance->setWindowFilePath("");
@@ -173,122 +289,286 @@ auto MainWindow::ShowError(
 // ====================================================================
 //  Internals
 // ====================================================================
-auto MainWindow::ApplySoundChanges() -> Result<> {
-    auto Norm = [](QComboBox* cbox, QString plain) -> Result<QString> {
-        const auto norm = [cbox] {
-            switch (cbox->currentIndex()) {
-                default: return text::NormalisationForm::None;
-                case 1: return text::NormalisationForm::NFC;
-                case 2: return text::NormalisationForm::NFD;
-            }
-        }();
-
-        return QString::fromStdString(Normalise(plain.toStdString(), norm));
-    };
+auto MainWindow::ApplySoundChanges(bool live) -> Result<> {
+    // The run is shared with the callback so it also ends if we fail or
+    // the request is cancelled.
+    auto run = std::make_shared<trace::Run>("apply");
+    trace::Scope scope{run->id()};
+    // Keep huge inputs in chunks rather than joining them; Lexurgy splits
+    // them into words anyway.
+    auto input = [&] {
+        trace::Timer _{"read input"};
+        return ui->input->chunks();
+    }();
+
+    {
+        trace::Timer _{"normalise input"};
+        for (auto& chunk : input) chunk = Try(Norm(ui->sca_cbox_input_norm, std::move(chunk)));
+    }
 
-    auto input = Try(Norm(ui->sca_cbox_input_norm, ui->input->toPlainText()));
-    auto changes = Try(Norm(ui->sca_cbox_changes_norm, ui->changes->toPlainText()));
+    auto changes = Try(GetSoundChanges());
 
-    // If javascript is enabled, find all instances of `§{}§` and replace them with
-    // the result of evaluating the javascript expression inside the braces.
-    if (ui->sca_chbox_enable_javascript->isChecked())
-        Try(EvaluateAndInterpolateJavaScript(changes));
+    // JavaScript may generate rules, so we need to update the 'Start After'/
+    // 'Stop Before' dropdowns if it is enabled; otherwise, they’re already
+    // up to date.
+    auto rule_names = [&] {
+        trace::Timer _{"rule names"};
+        return GetRuleNames(changes);
+    }();
+
+    if (ui->sca_chbox_enable_javascript->isChecked()) SetRuleNames(rule_names);
 
-    // Remember the 'Stop Before' rule that is currently selected.
+    // Don’t start at or stop before a rule that doesn’t exist.
     auto start_after = ui->sca_cbox_start_after->currentText();
     auto stop_before = ui->sca_cbox_stop_before->currentText();
+    if (not rule_names.contains(start_after)) start_after = "";
+    if (not rule_names.contains(stop_before)) stop_before = "";
+
+    // If we’re still waiting for the result of a previous apply, we don’t
+    // care about it anymore since we’re about to overwrite it anyway.
+    if (pending_apply) lexurgy::Cancel(std::exchange(pending_apply, 0));
+
+    // Dew it. The output is updated once Lexurgy is done.
+    pending_apply = Try(lexurgy::Apply(
+        input,
+        std::move(changes),
+        start_after,
+        stop_before,
+        [this, live, run](Result<QString> output) {
+            trace::Scope scope{run->id()};
+            pending_apply = 0;
+            ui->statusbar->clearMessage();
+            auto SetOutput = [&] -> Result<> {
+                auto text = Try(std::move(output));
+                text = Try([&] {
+                    trace::Timer _{"normalise output"};
+                    return Norm(ui->sca_cbox_output_norm, std::move(text));
+                }());
+
+                trace::Timer _{"update output"};
+                ui->output->updateText(text);
+                return {};
+            };
+
+            // Don’t pop up a dialog for every typo in live mode.
+            auto res = SetOutput();
+            ShowTiming(run->end());
+            if (live and not res) ui->statusbar->showMessage(QString::fromStdString(res.error()));
+            else HandleErrors(std::move(res));
+        }
+    ));
 
-    // Parse the sound changes to figure out what rules we have for the
-    // 'Stop Before' dropdown; rule names are lines that start with a name
-    // followed by a colon.
-    std::vector<QString> rule_names;
-    for (auto line : changes.split('\n')) {
-        line = line.trimmed();
-        if (
-            line.isEmpty() or
-            line.startsWith('#') or
-            line.startsWith('\\') or
-            line.contains("=>")
-        ) continue;
-
-        // If the line contains a colon, and everything before the colon
-        // does not contain whitespace, then this is the name of a rule;
-        // take everything up to the first whitespace character.
-        auto colon = line.indexOf(':');
-        if (colon == -1) continue;
-        auto ws = line.indexOf(QRegularExpression("\\s"));
-        auto name = line.mid(0, ws == -1 ? colon : std::min(colon, ws));
-        rule_names.push_back(name);
-    }
+    ui->statusbar->showMessage("Applying sound changes...");
+    return {};
+}
+
+auto MainWindow::EvaluateAndInterpolateJavaScript(QString& changes) -> Result<> {
+    return js.interpolate(changes);
+}
 
-    // Filter out special rules.
-    std::erase_if(rule_names, [](const QString& str) {
-        return str.startsWith("romanizer") or
-               str == "Then" or
-               str == "deromanizer" or
-               str == "Syllables";
-    });
-
-    // Update the 'Start After'/'Stop Before' dropdowns.
-    ui->sca_cbox_start_after->clear();
-    ui->sca_cbox_start_after->addItem("");
-    ui->sca_cbox_stop_before->clear();
-    ui->sca_cbox_stop_before->addItem("");
-    for (const auto& name : rule_names) {
-        ui->sca_cbox_start_after->addItem(name);
-        ui->sca_cbox_stop_before->addItem(name);
+auto MainWindow::ProfileSoundChanges() -> Result<> {
+    auto input = Try(Norm(ui->sca_cbox_input_norm, ui->input->text()));
+    auto changes = Try(GetSoundChanges());
+    auto names = GetRuleNames(changes);
+    std::vector<QString> rules{names.begin(), names.end()};
+    auto words = usz(input.split('\n', Qt::SkipEmptyParts).size());
+
+    // Profiling takes a while, so let the user keep working in the meantime.
+    if (pending_profile) lexurgy::Cancel(std::exchange(pending_profile, 0));
+    pending_profile = Try(lexurgy::Profile(
+        input,
+        std::move(changes),
+        std::move(rules),
+        [this, words](Result<std::vector<lexurgy::RuleProfile>> res) {
+            pending_profile = 0;
+            ui->statusbar->clearMessage();
+            if (not res) return HandleErrors(Error("{}", res.error()));
+            ProfileDialog::Show(*res, words, this);
+        }
+    ));
+
+    ui->statusbar->showMessage("Profiling sound changes...");
+    return {};
+}
+
+auto MainWindow::CountWords() -> Result<> {
+    auto generator = Try(wordgen::Generator::Compile(
+        ui->wordgen_classes_input->toPlainText(),
+        ui->wordgen_input_phono->text()
+    ));
+
+    auto all = Try(generator.space(false));
+    std::optional<wordgen::WordSpace> filtered;
+    if (generator.has_filters()) filtered = Try(generator.space(true));
+
+    TextPreviewDialog::Table table;
+    table.headers = {"Length", "Words"};
+    if (filtered) table.headers.push_back("After Filters");
+    for (auto [len, n] : all.counts() | vws::enumerate) {
+        if (n.is_zero()) continue;
+        QStringList row{QString::number(len), QString::fromStdString(n.str())};
+        if (filtered) {
+            auto counts = filtered->counts();
+            row.push_back(usz(len) < counts.size() ? QString::fromStdString(counts[usz(len)].str()) : "0");
+        }
+
+        table.rows.push_back(std::move(row));
     }
 
-    // If the rule that was selected before still exists, select it again; if
-    // not, do not stop before any rule.
-    if (rgs::contains(rule_names, start_after)) ui->sca_cbox_start_after->setCurrentText(start_after);
-    else start_after = "";
-    if (rgs::contains(rule_names, stop_before)) ui->sca_cbox_stop_before->setCurrentText(stop_before);
-    else stop_before = "";
+    auto text = std::format("The pattern generates {} distinct words.", all.size().str());
+    if (filtered) text += std::format(" {} of them remain after filters.", filtered->size().str());
+    TextPreviewDialog::Show(
+        "Word Generator: Word Count",
+        QString::fromStdString(text),
+        ui->wordgen_classes_input->font(),
+        this,
+        table
+    );
 
-    // Dew it.
-    auto output = Try(smyth::lexurgy::Apply(input, std::move(changes), start_after, stop_before));
-    ui->output->setPlainText(Try(Norm(ui->sca_cbox_output_norm, std::move(output))));
     return {};
 }
 
-auto MainWindow::EvaluateAndInterpolateJavaScript(QString& changes) -> Result<> {
-    QJSEngine js;
-    js.installExtensions(QJSEngine::ConsoleExtension);
-    qsizetype pos = 0;
-    for (;;) {
-        auto next = changes.indexOf("§{", pos);
-        if (next == -1) break;
-        auto end = changes.indexOf("}§", next);
-        if (end == -1) break;
-        auto expr = changes.mid(next + 2, end - next - 2);
-        auto result = js.evaluate(expr);
-        if (result.isError()) return Error(
-            "Exception in JS Evaluation: {}\nWhile evaluating:\n{}",
-            result.toString(),
-            expr
+auto MainWindow::GenerateWords() -> Result<> {
+    auto generator = Try(wordgen::Generator::Compile(
+        ui->wordgen_classes_input->toPlainText(),
+        ui->wordgen_input_phono->text()
+    ));
+
+    // Use a random seed if none is set. Keep it in the seed field (which
+    // is saved with the project) so the words can be generated again even
+    // after the status bar message is gone; put it in the placeholder so
+    // the next run still picks a new seed.
+    u64 seed;
+    auto seed_text = ui->wordgen_seed->text().trimmed();
+    if (seed_text.isEmpty()) {
+        seed = wordgen::RandomSeed();
+        ui->wordgen_seed->setPlaceholderText(QString::fromStdString(std::format("Random seed (last: {})", seed)));
+    } else {
+        bool ok = false;
+        seed = seed_text.toULongLong(&ok);
+        if (not ok) return Error(
+            "Invalid seed '{}'; seeds must be non-negative integers",
+            seed_text.toStdString()
         );
+    }
 
-        // Do not insert null or undefined.
-        if (not result.isNull() and not result.isUndefined()) {
-            auto str = result.toString();
-            changes.replace(next, end - next + 2, str);
-            pos = next + str.size();
-        } else {
-            changes.remove(next, end - next + 2);
-            pos = next;
-        }
+    // Index the dictionary column we’re checking against, if any; the
+    // first two entries mean ‘allow duplicates’ and ‘no duplicates’.
+    std::optional<wordgen::WordIndex> exclude;
+    auto dedup = ui->wordgen_cbox_dedup->currentIndex();
+    if (dedup == 1) {
+        exclude.emplace();
+    } else if (dedup >= 2) {
+        // Look the column up by the text of the entry rather than its data;
+        // an entry restored from a project may not have any data yet.
+        auto names = ui->dictionary_table->column_names();
+        auto col = rgs::find(names, ui->wordgen_cbox_dedup->currentText(), DedupLabel) - names.begin();
+        if (col == names.size()) return Error("No dictionary column for '{}'", ui->wordgen_cbox_dedup->currentText().toStdString());
+        exclude = Try(wordgen::WordIndex::Build(ui->dictionary_table->column_contents(int(col))));
+    }
+
+    // In uniform mode, every distinct word is equally likely, so weights
+    // are ignored and there is no distribution to show.
+    auto count = usz(ui->wordgen_count->value());
+    auto message = std::format("Seed: {}", seed);
+    auto exclude_ptr = exclude ? &*exclude : nullptr;
+    if (ui->wordgen_chbox_uniform->isChecked()) {
+        auto space = Try(generator.space());
+        if (space.size().is_zero()) return Error("The filters reject every word");
+        wordgen_frequencies.clear();
+        ui->wordgen_output->setPlainText(Try(space.sample(count, seed, exclude_ptr)));
+    } else {
+        auto words = Try(generator.generate(count, seed, exclude_ptr));
+        if (words.text.isEmpty()) return Error("The filters reject (almost) every word");
+        wordgen_frequencies = generator.frequencies(words.draws);
+        ui->wordgen_output->setPlainText(words.text);
+        if (words.rejected != 0) message += std::format(" | {} words rejected by filters", words.rejected);
+        if (words.duplicates != 0) message += std::format(" | {} duplicates discarded", words.duplicates);
     }
+
+    auto generated = usz(ui->wordgen_output->model()->rowCount());
+    if (generated < count) message += std::format(" | Only {} of {} words could be generated", generated, count);
+
+    ui->statusbar->showMessage(QString::fromStdString(message));
     return {};
 }
 
+auto MainWindow::GetRuleNames(const QString& changes) -> QStringList {
+    // If JavaScript is enabled, we need to look at what it generated.
+    if (ui->sca_chbox_enable_javascript->isChecked()) return RuleOutline::Parse(changes);
+    return outline->names();
+}
+
+auto MainWindow::GetSoundChanges() -> Result<QString> {
+    auto changes = Try([&] {
+        trace::Timer _{"normalise changes"};
+        return Norm(ui->sca_cbox_changes_norm, ui->changes->toPlainText());
+    }());
+
+    // If javascript is enabled, find all instances of `§{}§` and replace them with
+    // the result of evaluating the javascript expression inside the braces.
+    if (ui->sca_chbox_enable_javascript->isChecked()) {
+        trace::Timer _{"javascript"};
+        Try(EvaluateAndInterpolateJavaScript(changes));
+    }
+
+    return changes;
+}
+
+void MainWindow::SetRuleNames(const QStringList& names) {
+    // Keep whatever rule was selected before if it still exists; if not,
+    // don’t start at or stop before any rule.
+    auto Update = [&](QComboBox* cbox) {
+        auto selected = cbox->currentText();
+        cbox->clear();
+        cbox->addItem("");
+        cbox->addItems(names);
+        if (names.contains(selected)) cbox->setCurrentText(selected);
+    };
+
+    Update(ui->sca_cbox_start_after);
+    Update(ui->sca_cbox_stop_before);
+}
+
+void MainWindow::ShowTiming(const trace::Breakdown& b) {
+    auto Ms = [](trace::Clock::duration d) { return chr::duration<double, std::milli>(d).count(); };
+    QString tooltip;
+    for (auto [stage, time] : b.stages) {
+        if (not tooltip.isEmpty()) tooltip += '\n';
+        tooltip += QString::fromStdString(std::format("{}: {:.1f} ms", stage, Ms(time)));
+    }
+
+    timing_status->setText(QString::fromStdString(std::format("Applied in {:.0f} ms", Ms(b.total))));
+    timing_status->setToolTip(tooltip);
+    timing_status->setVisible(true);
+}
+
+void MainWindow::UpdateWordgenDedupColumns() {
+    // Keep the selected column if it still exists.
+    auto cbox = ui->wordgen_cbox_dedup;
+    auto selected = cbox->currentText();
+    cbox->clear();
+    cbox->addItem("Allow Duplicates");
+    cbox->addItem("No Duplicates");
+    for (const auto& name : ui->dictionary_table->column_names())
+        cbox->addItem(DedupLabel(name), name);
+    cbox->setCurrentIndex(std::max(0, cbox->findText(selected)));
+}
+
 // ====================================================================
 //  Slots
 // ====================================================================
 void MainWindow::apply_sound_changes() {
+    live_apply_timer->stop();
     HandleErrors(ApplySoundChanges());
 }
 
+void MainWindow::apply_sound_changes_live() {
+    if (not ui->sca_chbox_live->isChecked()) return;
+    auto res = ApplySoundChanges(true);
+    if (not res) ui->statusbar->showMessage(QString::fromStdString(res.error()));
+}
+
 void MainWindow::char_map_update_selection(char32_t codepoint) {
     static constexpr auto LC = text::CharCategory::LowercaseLetter;
     static constexpr auto UC = text::CharCategory::UppercaseLetter;
@@ -315,9 +595,38 @@ void MainWindow::char_map_update_selection(char32_t codepoint) {
     ui->char_map_details_panel->setHtml(QString::fromStdString(html));
 }
 
+void MainWindow::export_timing_trace() {
+    auto path = QFileDialog::getSaveFileName(
+        this,
+        "Export Timing Trace",
+        "smyth-trace.json",
+        "Chrome Trace Files (*.json)"
+    );
+
+    if (path.isEmpty()) return;
+    HandleErrors(trace::ExportChromeTrace(path));
+}
+
+void MainWindow::count_words() {
+    HandleErrors(CountWords());
+}
+
 void MainWindow::generate_words() {
-    std::println("Classes: {}", ui->wordgen_classes_input->toPlainText());
-    std::println("Phono: {}", ui->wordgen_input_phono->text());
+    HandleErrors(GenerateWords());
+}
+
+void MainWindow::goto_rule(int index) {
+    // The first entry is a placeholder.
+    if (index <= 0) return;
+    ui->sca_cbox_goto_rule->setCurrentIndex(0);
+    auto rules = outline->rules();
+    if (usz(index - 1) >= rules.size()) return;
+
+    // Put the rule at the top of the editor.
+    auto block = ui->changes->document()->findBlockByNumber(rules[usz(index - 1)].line);
+    ui->changes->moveCursor(QTextCursor::End);
+    ui->changes->setTextCursor(QTextCursor(block));
+    ui->changes->setFocus();
 }
 
 void MainWindow::new_project() {
@@ -347,7 +656,21 @@ void MainWindow::preview_changes_after_eval() {
         return;
     }
 
-    TextPreviewDialog::Show("Sound Changes: Preview", changes, ui->changes->font(), this);
+    // Show how long each expression took.
+    TextPreviewDialog::Table timings{.headers = {"Expression", "Time (ms)", "Cached"}};
+    for (const auto& t : js.timings()) {
+        timings.rows.push_back({
+            t.expression.simplified(),
+            QString::number(chr::duration<double, std::milli>(t.time).count(), 'f', 3),
+            t.cached ? "Yes" : "No",
+        });
+    }
+
+    TextPreviewDialog::Show("Sound Changes: Preview", changes, ui->changes->font(), this, timings);
+}
+
+void MainWindow::profile_sound_changes() {
+    HandleErrors(ProfileSoundChanges());
 }
 
 void MainWindow::prompt_quit() {
@@ -359,10 +682,67 @@ void MainWindow::save_project() {
     Project::Save();
 }
 
+void MainWindow::schedule_live_apply() {
+    if (not ui->sca_chbox_live->isChecked()) {
+        live_apply_timer->stop();
+        return;
+    }
+
+    // Whatever we’re waiting for is about to be out of date, so stop
+    // waiting for it now rather than once the timer fires; this way, we
+    // never queue up more than one request no matter how fast the user
+    // types.
+    if (pending_apply) lexurgy::Cancel(std::exchange(pending_apply, 0));
+    live_apply_timer->start();
+}
+
+void MainWindow::update_rule_names() {
+    // The dropdowns show the rules that JavaScript generated if it is
+    // enabled; those are updated when the changes are applied.
+    if (not ui->sca_chbox_enable_javascript->isChecked()) SetRuleNames(outline->names());
+
+    // The navigator always shows the rules in the editor.
+    ui->sca_cbox_goto_rule->clear();
+    ui->sca_cbox_goto_rule->addItem("");
+    for (const auto& r : outline->rules()) ui->sca_cbox_goto_rule->addItem(r.name);
+}
+
+void MainWindow::update_wordgen_dedup_columns() {
+    UpdateWordgenDedupColumns();
+}
+
 void MainWindow::show_project_directory() {
     Project::OpenDirInNativeShell();
 }
 
+void MainWindow::show_wordgen_distribution() {
+    if (wordgen_frequencies.empty()) {
+        ShowError("Generate some words first.", QMessageBox::Ok, "No Words");
+        return;
+    }
+
+    TextPreviewDialog::Table table;
+    table.headers = {"Class", "Member", "Expected", "Actual", "Picks"};
+    for (const auto& f : wordgen_frequencies) {
+        table.rows.push_back({
+            QString{f.cls},
+            f.member,
+            QString::fromStdString(std::format("{:.2f}%", f.expected * 100)),
+            QString::fromStdString(std::format("{:.2f}%", f.actual * 100)),
+            QString::number(f.draws),
+        });
+    }
+
+    TextPreviewDialog::Show(
+        "Word Generator: Distribution",
+        "How often each member of each class was picked in the last generated words, "
+        "compared to how often it should be picked based on its weight.",
+        ui->wordgen_classes_input->font(),
+        this,
+        table
+    );
+}
+
 // ====================================================================
 //  Events
 // ====================================================================
@@ -0,0 +1,354 @@
+#include <future>
+#include <QSet>
+#include <Smyth/NativeEngine.hh>
+#include <thread>
+#include <UI/Utils.hh>
+
+using namespace smyth;
+using namespace smyth::sca;
+
+namespace {
+/// Don’t bother with threads for inputs smaller than this.
+constexpr usz MinWordsPerChunk = 2'048;
+
+/// Maximum number of ways an expression may expand to; this only matters
+/// for expressions with lots of classes on the left-hand side.
+constexpr usz MaxAlternatives = 4'096;
+
+/// Check whether a character may appear in a literal.
+///
+/// ASCII punctuation is reserved by Lexurgy for one thing or another, and
+/// Lexurgy attaches combining characters to the segment before them, which
+/// we don’t do, so reject those. Precomposed characters are rejected as well
+/// to be on the safe side since they may be decomposed by Lexurgy.
+bool IsLiteral(QChar c) {
+    if (c.isSpace()) return false;
+    if (c.unicode() < 0x80) return c.isLetterOrNumber();
+    if (c.isMark()) return false;
+    return c.decompositionTag() == QChar::NoDecomposition;
+}
+
+/// Check whether a string is a valid rule or class name.
+bool IsName(QStringView name) {
+    return not name.isEmpty() and rgs::all_of(name, [](QChar c) {
+        return c.isLetterOrNumber() or c == '-' or c == '_';
+    });
+}
+
+/// Check whether a rule name is a keyword or some other kind of block
+/// that we don’t support.
+bool IsSpecialBlock(QStringView name) {
+    return name.startsWith(u"romanizer") or
+           name == u"Romanizer" or
+           name == u"Deromanizer" or
+           name == u"deromanizer" or
+           name == u"Syllables" or
+           name == u"Then" or
+           name == u"then" or
+           name == u"else";
+}
+
+/// Parse the items of a `{...}` set, without the braces.
+auto ParseSet(QStringView text, const QHash<QString, QStringList>& classes) -> Result<QStringList> {
+    QStringList items;
+    for (auto item : text.split(',')) {
+        item = item.trimmed();
+        if (item.startsWith('@')) {
+            auto it = classes.find(item.sliced(1).toString());
+            if (it == classes.end()) return Error("Unknown class '{}'", item.toString());
+            items += *it;
+            continue;
+        }
+
+        if (item.isEmpty() or not rgs::all_of(item, IsLiteral)) return Error("Unsupported set element '{}'", item.toString());
+        items.push_back(item.toString());
+    }
+    return items;
+}
+} // namespace
+
+// =====================================================================
+//  Parser
+// =====================================================================
+auto Engine::Compile(QStringView changes) -> Result<Engine> {
+    Engine e;
+    QHash<QString, QStringList> classes;
+    QSet<QString> names;
+    std::optional<usz> current;
+    for (auto line : changes.split('\n')) {
+        if (auto hash = line.indexOf('#'); hash != -1) line = line.first(hash);
+        line = line.trimmed();
+        if (line.isEmpty()) continue;
+
+        // Class declaration.
+        if (line.startsWith(u"Class ")) {
+            auto brace = line.indexOf('{');
+            if (brace == -1 or not line.endsWith('}')) return Error("Unsupported class declaration '{}'", line.toString());
+            auto name = line.sliced(6, brace - 6).trimmed();
+            if (not IsName(name) or classes.contains(name.toString())) return Error("Invalid class name '{}'", name.toString());
+            auto items = Try(ParseSet(line.sliced(brace + 1).chopped(1), classes));
+            classes.insert(name.toString(), std::move(items));
+            current = std::nullopt;
+            continue;
+        }
+
+        // Rule header, optionally followed by an expression.
+        if (auto colon = line.indexOf(':'); colon != -1) {
+            auto name = line.first(colon).trimmed();
+            if (not IsName(name)) return Error("Unsupported rule header '{}'", line.toString());
+            if (IsSpecialBlock(name)) return Error("Unsupported block '{}'", name.toString());
+            if (names.contains(name.toString())) return Error("Duplicate rule '{}'", name.toString());
+            names.insert(name.toString());
+            current = e.rules.size();
+            e.rules.emplace_back().name = name.toString();
+            line = line.sliced(colon + 1).trimmed();
+            if (line.isEmpty()) continue;
+        }
+
+        // Expression.
+        if (not current) return Error("Unsupported syntax '{}'", line.toString());
+        Try(ParseExpression(e.rules[*current], line, classes));
+    }
+
+    if (auto empty = rgs::find_if(e.rules, [](auto& r) { return r.expressions.empty(); }); empty != e.rules.end())
+        return Error("Rule '{}' is empty", empty->name);
+
+    return e;
+}
+
+auto Engine::ParseExpression(
+    Rule& r,
+    QStringView text,
+    const QHash<QString, QStringList>& classes
+) -> Result<> {
+    auto arrow = text.indexOf(u"=>");
+    if (arrow == -1 or text.indexOf(u"=>", arrow + 2) != -1) return Error("Unsupported expression '{}'", text.toString());
+    if (text.contains(u"//")) return Error("Exceptions are not supported");
+
+    // Split the expression into its parts.
+    auto lhs = text.first(arrow);
+    auto rest = text.sliced(arrow + 2);
+    auto slash = rest.indexOf('/');
+    auto rhs = slash == -1 ? rest : rest.first(slash);
+
+    Expression expr;
+    if (slash != -1) {
+        auto env = rest.sliced(slash + 1);
+        auto underscore = env.indexOf('_');
+        if (underscore == -1 or env.indexOf('_', underscore + 1) != -1) return Error("Unsupported environment '{}'", env.toString());
+        expr.before = Try(ParsePattern(env.first(underscore), classes, true));
+        expr.after = Try(ParsePattern(env.sliced(underscore + 1), classes, true));
+
+        // Word boundaries only make sense at the edges.
+        auto IsBoundary = [](const Element& el) { return el.alternatives.empty(); };
+        if (rgs::any_of(expr.before | vws::drop(1), IsBoundary) or
+            (not expr.after.empty() and rgs::any_of(expr.after | vws::take(expr.after.size() - 1), IsBoundary)))
+            return Error("Unsupported word boundary in '{}'", env.toString());
+    }
+
+    // Insertions aren’t supported.
+    auto from = Try(ParsePattern(lhs, classes, false));
+    if (from.empty()) return Error("Insertions are not supported");
+
+    // ‘*’ on its own deletes the match.
+    Pattern to;
+    if (rhs.trimmed() != u"*") {
+        to = Try(ParsePattern(rhs, classes, false));
+        if (to.empty()) return Error("Missing right-hand side in '{}'", text.toString());
+    }
+
+    // Sets in the output map to sets in the same position in the input.
+    bool to_has_sets = rgs::any_of(to, &Element::is_set);
+    if (to_has_sets) {
+        if (to.size() != from.size()) return Error("Unsupported set mapping in '{}'", text.toString());
+        for (auto [f, t] : vws::zip(from, to)) {
+            if (t.is_set and (not f.is_set or f.alternatives.size() != t.alternatives.size()))
+                return Error("Unsupported set mapping in '{}'", text.toString());
+        }
+    }
+
+    // Expand the left-hand side into every string it can match.
+    usz count = 1;
+    for (auto& el : from) {
+        count *= usz(el.alternatives.size());
+        if (count > MaxAlternatives) return Error("Expression '{}' is too complex", text.toString());
+    }
+
+    auto expression = u32(r.expressions.size());
+    std::vector<qsizetype> index(from.size());
+    for (usz n = 0; n < count; n++) {
+        Alternative alt{.from = {}, .to = {}, .expression = expression};
+        for (auto [i, el] : vws::enumerate(from)) alt.from += el.alternatives[index[usz(i)]];
+        for (auto [i, el] : vws::enumerate(to)) alt.to += el.alternatives[el.is_set ? index[usz(i)] : 0];
+
+        auto i = u32(r.alternatives.size());
+        r.by_first_char[alt.from.front()].push_back(i);
+        r.alternatives.push_back(std::move(alt));
+
+        // Advance to the next combination; the last element varies fastest.
+        for (usz k = from.size(); k-- > 0;) {
+            if (++index[k] < from[k].alternatives.size()) break;
+            index[k] = 0;
+        }
+    }
+
+    r.expressions.push_back(std::move(expr));
+    return {};
+}
+
+auto Engine::ParsePattern(
+    QStringView text,
+    const QHash<QString, QStringList>& classes,
+    bool environment
+) -> Result<Pattern> {
+    Pattern p;
+    for (qsizetype i = 0; i < text.size();) {
+        auto c = text[i];
+        if (c.isSpace()) {
+            i++;
+            continue;
+        }
+
+        // Class.
+        if (c == '@') {
+            auto end = i + 1;
+            while (end < text.size() and (text[end].isLetterOrNumber() or text[end] == '-' or text[end] == '_')) end++;
+            auto name = text.sliced(i + 1, end - i - 1);
+            auto it = classes.find(name.toString());
+            if (it == classes.end()) return Error("Unknown class '{}'", name.toString());
+            p.push_back({.alternatives = *it, .is_set = true});
+            i = end;
+            continue;
+        }
+
+        // Set.
+        if (c == '{') {
+            auto end = text.indexOf('}', i);
+            if (end == -1) return Error("Unterminated set in '{}'", text.toString());
+            auto items = Try(ParseSet(text.sliced(i + 1, end - i - 1), classes));
+            p.push_back({.alternatives = std::move(items), .is_set = true});
+            i = end + 1;
+            continue;
+        }
+
+        // Word boundary.
+        if (c == '$' and environment) {
+            p.push_back({});
+            i++;
+            continue;
+        }
+
+        // Literal; keep surrogate pairs together.
+        if (c.isHighSurrogate() and i + 1 < text.size() and text[i + 1].isLowSurrogate()) {
+            p.push_back({.alternatives = {text.sliced(i, 2).toString()}});
+            i += 2;
+            continue;
+        }
+
+        if (not IsLiteral(c)) return Error("Unsupported character '{}' in '{}'", QString{c}, text.toString());
+        p.push_back({.alternatives = {QString{c}}});
+        i++;
+    }
+    return p;
+}
+
+// =====================================================================
+//  Matching
+// =====================================================================
+auto Engine::apply(
+    std::span<const QStringView> words,
+    QStringView start_at,
+    QStringView stop_before
+) const -> Result<QString> {
+    auto Find = [&](QStringView name) -> Result<usz> {
+        auto it = rgs::find_if(rules, [&](auto& r) { return r.name == name; });
+        if (it == rules.end()) return Error("No rule named '{}'", name.toString());
+        return usz(it - rules.begin());
+    };
+
+    auto begin = start_at.isEmpty() ? usz(0) : Try(Find(start_at));
+    auto end = stop_before.isEmpty() ? rules.size() : Try(Find(stop_before));
+    if (end < begin) return Error("'{}' comes after '{}'", start_at.toString(), stop_before.toString());
+
+    for (auto w : words) {
+        auto bad = rgs::find_if_not(w, [](QChar c) { return IsLiteral(c) or c.isSurrogate(); });
+        if (bad != w.end()) return Error("Unsupported character '{}' in '{}'", QString{*bad}, w.toString());
+    }
+
+    auto active = std::span{rules}.subspan(begin, end - begin);
+    auto Run = [active](std::span<const QStringView> chunk) {
+        QString out, current, next;
+        for (auto w : chunk) {
+            current = w.toString();
+            for (auto& r : active) {
+                next.clear();
+                ApplyRule(r, current, next);
+                std::swap(current, next);
+            }
+            out += current;
+            out += '\n';
+        }
+        return out;
+    };
+
+    // Split the input into chunks and process them in parallel; the first
+    // one is done on this thread.
+    auto threads = usz(std::max(1u, std::thread::hardware_concurrency()));
+    auto chunks = std::clamp<usz>(words.size() / MinWordsPerChunk, 1, threads);
+    if (chunks == 1) return Run(words);
+
+    auto chunk_size = (words.size() + chunks - 1) / chunks;
+    std::vector<std::future<QString>> futures;
+    for (usz i = 1; i < chunks; i++) {
+        auto from = std::min(i * chunk_size, words.size());
+        auto to = std::min(from + chunk_size, words.size());
+        futures.push_back(std::async(std::launch::async, Run, words.subspan(from, to - from)));
+    }
+
+    auto out = Run(words.first(std::min(chunk_size, words.size())));
+    for (auto& f : futures) out += f.get();
+    return out;
+}
+
+void Engine::ApplyRule(const Rule& r, QStringView word, QString& out) {
+    for (qsizetype i = 0; i < word.size();) {
+        auto it = r.by_first_char.constFind(word[i]);
+        if (it != r.by_first_char.cend()) {
+            auto matched = rgs::find_if(*it, [&](u32 index) {
+                auto& alt = r.alternatives[index];
+                auto& e = r.expressions[alt.expression];
+                return word.sliced(i).startsWith(alt.from) and
+                       MatchBefore(e.before, word, i) and
+                       MatchAfter(e.after, word, i + alt.from.size());
+            });
+
+            if (matched != it->end()) {
+                auto& alt = r.alternatives[*matched];
+                out += alt.to;
+                i += alt.from.size();
+                continue;
+            }
+        }
+
+        out += word[i++];
+    }
+}
+
+bool Engine::MatchAfter(std::span<const Element> p, QStringView word, qsizetype pos) {
+    if (p.empty()) return true;
+    auto& el = p.front();
+    if (el.alternatives.empty()) return pos == word.size() and MatchAfter(p.subspan(1), word, pos);
+    return rgs::any_of(el.alternatives, [&](const QString& alt) {
+        return word.sliced(pos).startsWith(alt) and MatchAfter(p.subspan(1), word, pos + alt.size());
+    });
+}
+
+bool Engine::MatchBefore(std::span<const Element> p, QStringView word, qsizetype pos) {
+    if (p.empty()) return true;
+    auto& el = p.back();
+    auto rest = p.first(p.size() - 1);
+    if (el.alternatives.empty()) return pos == 0 and MatchBefore(rest, word, pos);
+    return rgs::any_of(el.alternatives, [&](const QString& alt) {
+        return word.first(pos).endsWith(alt) and MatchBefore(rest, word, pos - alt.size());
+    });
+}
@@ -45,6 +45,11 @@ auto Serialiser<QFont>::Deserialise(const json& tn) -> Result<QFont> {
     return f;
 }
 
+auto Serialiser<ChunkedText>::Deserialise(const json& j) -> Result<ChunkedText> {
+    const std::string& text = Try(Get<std::string>(j));
+    return ChunkedText::FromUtf8(QByteArrayView{text.data(), qsizetype(text.size())});
+}
+
 auto Serialiser<QSize>::Deserialise(const json& tn) -> Result<QSize> {
     const json::array_t& arr = Try(Get<json::array_t>(tn));
     if (arr.size() != 2) return Error("Expected array of size 2 when reading QSize");
@@ -66,6 +71,18 @@ auto Serialiser<QByteArray>::Serialise(const QByteArray& val) -> json {
     return Serialiser<std::string>::Serialise(arr.toStdString());
 }
 
+auto Serialiser<ChunkedText>::Serialise(const ChunkedText& val) -> json {
+    // Encode the chunks one by one rather than joining them first; this
+    // is stored as a plain string, same as a QString.
+    std::string text;
+    text.reserve(usz(val.size()));
+    for (const auto& c : val.chunks()) {
+        auto utf8 = c.toUtf8();
+        text.append(utf8.constData(), usz(utf8.size()));
+    }
+    return Serialiser<std::string>::Serialise(std::move(text));
+}
+
 auto Serialiser<QFont>::Serialise(const QFont& val) -> json {
     return Serialiser<QString>::Serialise(val.toString());
 }
@@ -0,0 +1,53 @@
+#include <cmath>
+#include <QTableWidgetItem>
+#include <UI/ProfileDialog.hh>
+#include <ui_ProfileDialog.h>
+
+smyth::ui::ProfileDialog::~ProfileDialog() noexcept = default;
+
+smyth::ui::ProfileDialog::ProfileDialog(QWidget* parent)
+    : QDialog(parent), ui(std::make_unique<Ui::ProfileDialog>()) {
+    ui->setupUi(this);
+}
+
+void smyth::ui::ProfileDialog::Show(
+    std::span<const lexurgy::RuleProfile> results,
+    usz words,
+    QWidget* parent
+) {
+    // Use numbers rather than text for the numeric columns so sorting
+    // by them works properly.
+    auto Number = [](auto value) {
+        auto item = new QTableWidgetItem;
+        item->setData(Qt::DisplayRole, value);
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        return item;
+    };
+
+    chr::nanoseconds total{};
+    for (const auto& r : results) total += r.time;
+    auto total_ms = chr::duration<double, std::milli>(total).count();
+
+    ProfileDialog dialog{parent};
+    auto table = dialog.ui->table;
+    table->setRowCount(int(results.size()));
+    for (auto [row, r] : results | vws::enumerate) {
+        auto ms = chr::duration<double, std::milli>(r.time).count();
+        auto name = r.rule.isEmpty() ? QString("(before first rule)") : r.rule;
+        table->setItem(int(row), 0, new QTableWidgetItem(name));
+        table->setItem(int(row), 1, Number(std::round(ms * 10) / 10));
+        table->setItem(int(row), 2, Number(total_ms == 0 ? 0. : std::round(ms / total_ms * 1'000) / 10));
+        table->setItem(int(row), 3, Number(qulonglong(r.words_changed)));
+    }
+
+    table->resizeColumnsToContents();
+    dialog.ui->summary->setText(QString::fromStdString(std::format(
+        "{} rules applied to {} words in {:.1f} ms",
+        results.size(),
+        words,
+        total_ms
+    )));
+
+    dialog.setWindowTitle("Sound Changes: Profile");
+    dialog.exec();
+}
@@ -0,0 +1,146 @@
+#include <QTextBlock>
+#include <QTextBlockUserData>
+#include <UI/RuleOutline.hh>
+
+using namespace smyth;
+using namespace smyth::ui;
+
+/// Attached to every line that starts a rule.
+///
+/// Qt deletes this when the line is deleted, which is the only way we
+/// find out that a rule was removed along with it without rescanning
+/// the entire document.
+class RuleOutline::BlockData final : public QTextBlockUserData {
+public:
+    RuleOutline* outline;
+    QString name;
+
+    BlockData(RuleOutline* outline, QString name)
+        : outline(outline), name(std::move(name)) {}
+
+    ~BlockData() override { outline->structure_changed = true; }
+};
+
+// ====================================================================
+//  Initialisation
+// ====================================================================
+RuleOutline::RuleOutline(QTextDocument* document, QObject* parent)
+    : QObject(parent), document(document) {
+    connect(document, &QTextDocument::contentsChange, this, &RuleOutline::Update);
+    Update(0, 0, document->characterCount());
+}
+
+RuleOutline::~RuleOutline() noexcept {
+    // The document may outlive us, so make sure none of the data we’ve
+    // attached to it refers to us anymore.
+    if (not document) return;
+    for (auto b = document->begin(); b != document->end(); b = b.next())
+        if (b.userData()) b.setUserData(nullptr);
+}
+
+// ====================================================================
+//  API
+// ====================================================================
+auto RuleOutline::find(QStringView name) -> const Rule* {
+    auto r = rules();
+    auto it = rgs::find(r, name, &Rule::name);
+    return it == r.end() ? nullptr : &*it;
+}
+
+bool RuleOutline::IsSpecial(QStringView name) {
+    return name.startsWith(u"romanizer") or
+           name == u"Then" or
+           name == u"deromanizer" or
+           name == u"Syllables";
+}
+
+auto RuleOutline::Parse(QStringView text) -> QStringList {
+    QStringList names;
+    for (auto line : text.split('\n')) {
+        auto name = ParseRuleName(line);
+        if (name and not IsSpecial(*name)) names.push_back(name->toString());
+    }
+    return names;
+}
+
+auto RuleOutline::ParseRuleName(QStringView line) -> std::optional<QStringView> {
+    line = line.trimmed();
+    if (
+        line.isEmpty() or
+        line.startsWith('#') or
+        line.startsWith('\\') or
+        line.contains(u"=>")
+    ) return std::nullopt;
+
+    // If the line contains a colon, then this is the name of a rule; take
+    // everything up to the colon or the first whitespace character.
+    auto colon = line.indexOf(':');
+    if (colon == -1) return std::nullopt;
+    auto end = rgs::find_if(line.first(colon), [](QChar c) { return c.isSpace(); });
+    return line.first(end - line.begin());
+}
+
+auto RuleOutline::rules() -> std::span<const Rule> {
+    if (not positions_changed) return cached_rules;
+    positions_changed = false;
+    cached_rules.clear();
+
+    // Only lines that start a rule have data attached to them, so this
+    // doesn’t need to look at the text at all.
+    for (auto b = document->begin(); b != document->end(); b = b.next()) {
+        auto data = static_cast<BlockData*>(b.userData());
+        if (not data) continue;
+        if (not cached_rules.empty()) cached_rules.back().end = b.position();
+        cached_rules.push_back(Rule{
+            .name = data->name,
+            .line = b.blockNumber(),
+            .begin = b.position(),
+            .end = document->characterCount(),
+            .special = IsSpecial(data->name),
+        });
+    }
+
+    return cached_rules;
+}
+
+// ====================================================================
+//  Implementation
+// ====================================================================
+void RuleOutline::RebuildNames() {
+    structure_changed = false;
+    QStringList all, names;
+    for (const auto& r : rules()) {
+        all.push_back(r.name);
+        if (not r.special) names.push_back(r.name);
+    }
+
+    // Editing a rule’s header without changing its name still counts as
+    // a change to the structure, so check if anything actually changed.
+    if (all == cached_all_names) return;
+    cached_all_names = std::move(all);
+    cached_names = std::move(names);
+    emit namesChanged();
+}
+
+void RuleOutline::Update(int position, int, int added) {
+    positions_changed = true;
+
+    // Reparse every line that was touched by the edit.
+    auto first = document->findBlock(position);
+    auto last = document->findBlock(position + added);
+    if (not last.isValid()) last = document->lastBlock();
+    for (auto b = first; b.isValid(); b = b.next()) {
+        auto data = static_cast<BlockData*>(b.userData());
+        auto name = ParseRuleName(b.text());
+        if (not name) {
+            if (data) b.setUserData(nullptr);
+        } else if (not data or data->name != *name) {
+            b.setUserData(new BlockData(this, name->toString()));
+            structure_changed = true;
+        }
+
+        if (b == last) break;
+    }
+
+    if (structure_changed) RebuildNames();
+}
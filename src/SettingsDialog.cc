@@ -1,6 +1,7 @@
 #include <base/Numeric.hh>
 #include <base/Stream.hh>
 #include <UI/MainWindow.hh>
+#include <UI/PersistObjects.hh>
 #include <UI/SettingsDialog.hh>
 #include <UI/SmythDictionary.hh>
 #include <ui_SettingsDialog.h>
@@ -22,9 +23,48 @@ SettingsDialog::SettingsDialog(MainWindow* main)
         this,
         &SettingsDialog::toggle_show_json_requests
     );
+
+    connect(
+        ui->lexurgy_servers,
+        &QSpinBox::valueChanged,
+        this,
+        &SettingsDialog::set_lexurgy_servers
+    );
+
+    connect(
+        ui->lexurgy_in_process,
+        &QCheckBox::toggled,
+        this,
+        &SettingsDialog::toggle_lexurgy_in_process
+    );
+
+    connect(
+        ui->lexurgy_native_engine,
+        &QCheckBox::toggled,
+        this,
+        &SettingsDialog::toggle_native_engine
+    );
+
+#ifndef SMYTH_LEXURGY_JNI
+    ui->lexurgy_in_process->setVisible(false);
+#endif
 }
 
 void SettingsDialog::Init() {
+    settings::LexurgyServers.subscribe([this](int count) {
+        ui->lexurgy_servers->setValue(count);
+    });
+
+    settings::NativeEngine.subscribe([this](bool checked) {
+        ui->lexurgy_native_engine->setChecked(checked);
+    });
+
+#ifdef SMYTH_LEXURGY_JNI
+    settings::LexurgyInProcess.subscribe([this](bool checked) {
+        ui->lexurgy_in_process->setChecked(checked);
+    });
+#endif
+
 #ifdef LIBBASE_DEBUG
     settings::DumpJsonRequests.subscribe([this](bool checked) {
         ui->debug_show_json->setChecked(checked);
@@ -41,6 +81,8 @@ void SettingsDialog::Persist() {
         "duplicate_rows",
         ui->text_duplicate_rows
     );
+
+    PersistChBox(store, "lexurgy.save_cache", ui->lexurgy_save_cache);
 }
 
 // ====================================================================
@@ -67,6 +109,10 @@ auto SettingsDialog::GetRowsToDuplicate() -> Result<QList<int>> {
     return indices;
 }
 
+bool SettingsDialog::SaveLexurgyCache() {
+    return Instance->ui->lexurgy_save_cache->isChecked();
+}
+
 void SettingsDialog::Reset() {
     // No-op. Add project-specific settings here if need be.
 }
@@ -84,6 +130,10 @@ void SettingsDialog::set_default_font() {
     SetFont(settings::SerifFont, ui->font_default);
 }
 
+void SettingsDialog::set_lexurgy_servers(int count) {
+    settings::LexurgyServers.set(count);
+}
+
 void SettingsDialog::set_mono_font() {
     SetFont(settings::MonoFont, ui->font_mono);
 }
@@ -92,6 +142,16 @@ void SettingsDialog::set_notes_font() {
     SetFont(settings::SansFont, ui->font_notes);
 }
 
+void SettingsDialog::toggle_lexurgy_in_process() {
+#ifdef SMYTH_LEXURGY_JNI
+    settings::LexurgyInProcess.set(ui->lexurgy_in_process->isChecked());
+#endif
+}
+
+void SettingsDialog::toggle_native_engine() {
+    settings::NativeEngine.set(ui->lexurgy_native_engine->isChecked());
+}
+
 void SettingsDialog::toggle_show_json_requests() {
 #ifdef LIBBASE_DEBUG
     settings::DumpJsonRequests.set(ui->debug_show_json->isChecked());
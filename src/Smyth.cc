@@ -1,5 +1,6 @@
 #include <base/FS.hh>
 #include <filesystem>
+#include <print>
 #include <QDesktopServices>
 #include <QFileDialog>
 #include <UI/Lexurgy.hh>
@@ -51,6 +52,12 @@ void ui::HandleErrors(Result<> r) {
 /// that no project-specific state is leaked between projects.
 Project CurrentProject;
 
+/// Get the path of the file that Lexurgy results are cached in.
+static auto LexurgyCachePath(const QString& project_path) -> QString {
+    auto path = fs::path(project_path.toStdString()).replace_extension(".lexurgy-cache");
+    return QString::fromStdString(path.string());
+}
+
 Project::Project(QString path)
     : SavePath(std::move(path)),
       LastSaveTime(chr::system_clock::now()) {}
@@ -204,9 +211,26 @@ auto Project::OpenImpl(QString path, bool opening_last_open_project) -> Result<>
         return res;
     }
 
+    // Don’t let JavaScript state or results for the previous project leak
+    // into this one.
+    MainWindow::ResetJavaScript();
+    MainWindow::CancelPendingRequests();
+    lexurgy::ClearCache();
+
     // Update save path and remember it.
     CurrentProject = Project(path);
     settings::LastOpenProject.set(path);
+
+    // Load cached sound change results. A missing or broken cache isn’t
+    // a problem since we can always just recompute everything.
+    if (SettingsDialog::SaveLexurgyCache()) {
+        auto cache = lexurgy::LoadCache(LexurgyCachePath(path));
+        if (not cache) std::println(stderr, "Ignoring Lexurgy cache: {}", cache.error());
+    }
+
+    // Get Lexurgy ready in the background.
+    MainWindow::PrewarmLexurgy();
+
     return {};
 }
 
@@ -244,6 +268,8 @@ auto Project::SaveImpl() -> Result<> {
     Assert(not j.contains("version"), "Top-level 'version' key already set?");
     j["version"] = SMYTH_CURRENT_CONFIG_FILE_VERSION;
     Try(File::Write(CurrentProject.SavePath.toStdString(), j.dump(4)));
+    if (SettingsDialog::SaveLexurgyCache())
+        Try(lexurgy::SaveCache(LexurgyCachePath(CurrentProject.SavePath)));
 
     // Update last save time.
     CurrentProject.LastSaveTime = std::chrono::system_clock::now();
@@ -385,6 +385,25 @@ void SmythDictionary::duplicate_entry(bool) {
     HandleErrors(DuplicateSelectedEntry());
 }
 
+auto SmythDictionary::column_contents(int col) const -> QStringList {
+    QStringList contents;
+    contents.reserve(rowCount());
+    for (int row = 0; row < rowCount(); ++row)
+        if (auto it = item(row, col)) contents.push_back(it->text());
+    return contents;
+}
+
+auto SmythDictionary::column_names() const -> QStringList {
+    QStringList names;
+    for (int col = 0; col < columnCount(); ++col) {
+        auto it = horizontalHeaderItem(col);
+        if (auto header = dynamic_cast<HeaderItem*>(it)) names.push_back(header->name());
+        else if (it) names.push_back(it->text());
+        else names.push_back(QString::number(col + 1));
+    }
+    return names;
+}
+
 void SmythDictionary::contextMenuEvent(QContextMenuEvent* event) {
     context_menu->popup(mapToGlobal(event->pos()));
 }
@@ -0,0 +1,170 @@
+#include <QBrush>
+#include <QClipboard>
+#include <QGuiApplication>
+#include <QKeyEvent>
+#include <UI/SmythOutputView.hh>
+
+using namespace smyth;
+using namespace smyth::ui;
+
+namespace {
+/// Split text into lines, ignoring the newline at the very end.
+auto SplitLines(const QString& text) -> QStringList {
+    auto lines = text.split('\n');
+    if (not lines.empty() and lines.back().isEmpty()) lines.pop_back();
+    return lines;
+}
+} // namespace
+
+// ====================================================================
+//  Model
+// ====================================================================
+auto SmythOutputView::Model::data(const QModelIndex& index, int role) const -> QVariant {
+    if (not index.isValid() or index.row() >= lines.size()) return {};
+    switch (role) {
+        case Qt::DisplayRole:
+        case Qt::EditRole:
+            return lines[index.row()];
+
+        case Qt::BackgroundRole:
+            if (changed[usz(index.row())]) return QBrush{highlight};
+            return {};
+
+        default:
+            return {};
+    }
+}
+
+auto SmythOutputView::Model::rowCount(const QModelIndex& parent) const -> int {
+    return parent.isValid() ? 0 : int(lines.size());
+}
+
+void SmythOutputView::Model::reset(QStringList new_lines) {
+    beginResetModel();
+    lines = std::move(new_lines);
+    changed.assign(usz(lines.size()), false);
+    endResetModel();
+}
+
+void SmythOutputView::Model::update(QStringList new_lines) {
+    // Skip everything at the start and end that is the same; usually, the
+    // number of lines doesn’t change at all, in which case this is just a
+    // line-by-line comparison.
+    auto old_size = lines.size();
+    auto new_size = new_lines.size();
+    auto common = std::min(old_size, new_size);
+    qsizetype prefix = 0, suffix = 0;
+    while (prefix < common and lines[prefix] == new_lines[prefix]) prefix++;
+    while (suffix < common - prefix and lines[old_size - 1 - suffix] == new_lines[new_size - 1 - suffix]) suffix++;
+
+    // Compare the lines in between that exist in both.
+    auto old_mid = old_size - prefix - suffix;
+    auto new_mid = new_size - prefix - suffix;
+    auto overlap = std::min(old_mid, new_mid);
+    std::vector<bool> now(usz(new_size));
+    for (auto i = prefix; i < prefix + overlap; i++) {
+        if (lines[i] == new_lines[i]) continue;
+        lines[i] = std::move(new_lines[i]);
+        now[usz(i)] = true;
+    }
+
+    // Insert or remove whatever is left.
+    auto pos = prefix + overlap;
+    if (new_mid > old_mid) {
+        auto count = new_mid - old_mid;
+        beginInsertRows({}, int(pos), int(pos + count - 1));
+        lines.insert(pos, count, QString{});
+        changed.insert(changed.begin() + pos, usz(count), false);
+        for (auto i = pos; i < pos + count; i++) {
+            lines[i] = std::move(new_lines[i]);
+            now[usz(i)] = true;
+        }
+        endInsertRows();
+    } else if (old_mid > new_mid) {
+        auto count = old_mid - new_mid;
+        beginRemoveRows({}, int(pos), int(pos + count - 1));
+        lines.remove(pos, count);
+        changed.erase(changed.begin() + pos, changed.begin() + pos + count);
+        endRemoveRows();
+    }
+
+    // Repaint lines whose text or highlighting changed, in runs.
+    Assert(changed.size() == now.size(), "Line count mismatch after diff");
+    std::swap(changed, now);
+    for (usz i = 0; i < changed.size();) {
+        if (not changed[i] and not now[i]) {
+            i++;
+            continue;
+        }
+
+        auto start = i;
+        while (i < changed.size() and (changed[i] or now[i])) i++;
+        emit dataChanged(index(int(start)), index(int(i - 1)));
+    }
+}
+
+// ====================================================================
+//  View
+// ====================================================================
+SmythOutputView::SmythOutputView(QWidget* parent) : QListView(parent) {
+    setModel(&model);
+    setEditTriggers(NoEditTriggers);
+    setSelectionMode(ExtendedSelection);
+
+    // Every line has the same height, so the view doesn’t need to lay out
+    // every line to figure out where everything goes.
+    setUniformItemSizes(true);
+    setLayoutMode(Batched);
+    setBatchSize(1'000);
+
+    model.highlight = palette().color(QPalette::Highlight);
+    model.highlight.setAlpha(48);
+}
+
+void SmythOutputView::changeEvent(QEvent* event) {
+    if (event->type() == QEvent::PaletteChange) {
+        model.highlight = palette().color(QPalette::Highlight);
+        model.highlight.setAlpha(48);
+        viewport()->update();
+    }
+
+    QListView::changeEvent(event);
+}
+
+void SmythOutputView::copy() {
+    auto rows = selectionModel()->selectedRows();
+    if (rows.empty()) return;
+    rgs::sort(rows, {}, &QModelIndex::row);
+
+    QString text;
+    for (auto& r : rows) {
+        text += model.text()[r.row()];
+        text += '\n';
+    }
+
+    QGuiApplication::clipboard()->setText(text);
+}
+
+void SmythOutputView::keyPressEvent(QKeyEvent* event) {
+    if (HandleZoomEvent(event)) return;
+    if (event->matches(QKeySequence::Copy)) {
+        copy();
+        event->accept();
+        return;
+    }
+
+    QListView::keyPressEvent(event);
+}
+
+void SmythOutputView::setPlainText(const QString& text) {
+    model.reset(SplitLines(text));
+}
+
+auto SmythOutputView::toPlainText() const -> QString {
+    if (model.text().empty()) return {};
+    return model.text().join('\n') + '\n';
+}
+
+void SmythOutputView::updateText(const QString& text) {
+    model.update(SplitLines(text));
+}
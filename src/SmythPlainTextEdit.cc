@@ -0,0 +1,135 @@
+#include <QContextMenuEvent>
+#include <QFileDialog>
+#include <QMenu>
+#include <QMimeData>
+#include <UI/MainWindow.hh>
+#include <UI/SmythPlainTextEdit.hh>
+
+using namespace smyth;
+using namespace smyth::ui;
+
+auto SmythPlainTextEdit::chunks() const -> QList<QString> {
+    if (large) return large->chunks();
+    return {toPlainText()};
+}
+
+void SmythPlainTextEdit::contextMenuEvent(QContextMenuEvent* event) {
+    std::unique_ptr<QMenu> menu{createStandardContextMenu()};
+    if (large_documents_enabled) {
+        menu->addSeparator();
+        menu->addAction("Load File…", this, &This::load_file);
+        if (large) menu->addAction("Edit Full Text", this, &This::edit_full_text);
+    }
+
+    menu->exec(event->globalPos());
+}
+
+void SmythPlainTextEdit::edit_full_text() {
+    if (not large) return;
+    auto res = MainWindow::Prompt(
+        "Edit Full Text",
+        QString::fromStdString(std::format(
+            "This text has {} lines, and editing it directly may be very slow. Continue?",
+            large->lines()
+        ))
+    );
+
+    if (res != QMessageBox::Yes) return;
+    auto text = large->str();
+    LeaveLargeDocumentMode();
+    setPlainText(text);
+}
+
+void SmythPlainTextEdit::EnterLargeDocumentMode(ChunkedText text) {
+    if (not large) was_read_only = isReadOnly();
+    large = std::move(text);
+
+    auto preview = large->preview(LargeDocumentPreviewLines);
+    if (large->lines() > LargeDocumentPreviewLines) {
+        if (not preview.endsWith('\n')) preview += '\n';
+        preview += QString::fromStdString(std::format(
+            "[… {} more lines; right-click and select ‘Edit Full Text’ to show everything]",
+            large->lines() - LargeDocumentPreviewLines
+        ));
+    }
+
+    setReadOnly(true);
+    setPlainText(preview);
+}
+
+void SmythPlainTextEdit::insertFromMimeData(const QMimeData* source) {
+    // Pasting something huge replaces the document with a large one; that
+    // can’t be undone, so ask first, and don’t paste anything otherwise.
+    if (large_documents_enabled and not large and source->hasText()) {
+        auto pasted = source->text();
+        auto cursor = textCursor();
+        auto current = toPlainText();
+        if (current.size() + pasted.size() >= LargeDocumentThreshold) {
+            auto res = MainWindow::Prompt(
+                "Paste Large Text",
+                "The text is too large to be edited directly, so only a read-only "
+                "preview will be shown, and this paste cannot be undone. Continue?"
+            );
+
+            if (res != QMessageBox::Yes) return;
+            current.replace(cursor.selectionStart(), cursor.selectionEnd() - cursor.selectionStart(), pasted);
+            setText(current);
+            return;
+        }
+    }
+
+    QPlainTextEdit::insertFromMimeData(source);
+}
+
+void SmythPlainTextEdit::LeaveLargeDocumentMode() {
+    if (not large) return;
+    large.reset();
+    setReadOnly(was_read_only);
+}
+
+void SmythPlainTextEdit::load_file() {
+    auto path = QFileDialog::getOpenFileName(
+        this,
+        "Load File",
+        "",
+        "Text Files (*.txt);;All Files (*)"
+    );
+
+    if (path.isEmpty()) return;
+    if (auto res = loadFile(path); not res) MainWindow::ShowError(QString::fromStdString(res.error()));
+}
+
+auto SmythPlainTextEdit::loadFile(const QString& path) -> Result<> {
+    setSnapshot(Try(ChunkedText::Map(path)));
+    return {};
+}
+
+void SmythPlainTextEdit::setSnapshot(ChunkedText text) {
+    if (large_documents_enabled and text.size() >= LargeDocumentThreshold) {
+        EnterLargeDocumentMode(std::move(text));
+        return;
+    }
+
+    LeaveLargeDocumentMode();
+    setPlainText(text.str());
+}
+
+void SmythPlainTextEdit::setText(const QString& text) {
+    if (large_documents_enabled and text.size() >= LargeDocumentThreshold) {
+        EnterLargeDocumentMode(ChunkedText{text});
+        return;
+    }
+
+    LeaveLargeDocumentMode();
+    setPlainText(text);
+}
+
+auto SmythPlainTextEdit::snapshot() const -> ChunkedText {
+    if (large) return *large;
+    return ChunkedText{toPlainText()};
+}
+
+auto SmythPlainTextEdit::text() const -> QString {
+    if (large) return large->str();
+    return toPlainText();
+}
@@ -0,0 +1,95 @@
+#include <QClipboard>
+#include <QGuiApplication>
+#include <QKeyEvent>
+#include <UI/SmythWordList.hh>
+
+using namespace smyth;
+using namespace smyth::ui;
+
+// ====================================================================
+//  Model
+// ====================================================================
+auto SmythWordList::Model::data(const QModelIndex& index, int role) const -> QVariant {
+    if (not index.isValid() or index.row() >= rowCount()) return {};
+    if (role != Qt::DisplayRole and role != Qt::EditRole) return {};
+    return word(usz(index.row())).toString();
+}
+
+auto SmythWordList::Model::rowCount(const QModelIndex& parent) const -> int {
+    return parent.isValid() ? 0 : int(starts.size() - 1);
+}
+
+void SmythWordList::Model::reset(const QString& text) {
+    beginResetModel();
+    words = text;
+    starts.assign(1, 0);
+    if (not words.isEmpty() and not words.endsWith('\n')) words += '\n';
+
+    // Index the words, dropping empty lines and anything past the limit;
+    // usually, there is nothing to drop, in which case we don’t have to
+    // copy anything.
+    qsizetype keep = 0;
+    for (qsizetype pos = 0; pos < words.size() and starts.size() <= MaxWords;) {
+        auto end = words.indexOf('\n', pos);
+        if (end != pos) {
+            if (keep != pos) {
+                std::copy(words.cbegin() + pos, words.cbegin() + end, words.begin() + keep);
+                words[keep + end - pos] = '\n';
+            }
+
+            keep += end - pos + 1;
+            starts.push_back(keep);
+        }
+
+        pos = end + 1;
+    }
+
+    if (keep != words.size()) words.truncate(keep);
+    endResetModel();
+}
+
+auto SmythWordList::Model::word(usz index) const -> QStringView {
+    auto start = starts[index];
+    return QStringView{words}.sliced(start, starts[index + 1] - start - 1);
+}
+
+// ====================================================================
+//  View
+// ====================================================================
+SmythWordList::SmythWordList(QWidget* parent) : QListView(parent) {
+    setModel(&model);
+    setEditTriggers(NoEditTriggers);
+    setSelectionMode(ExtendedSelection);
+    setUniformItemSizes(true);
+    setLayoutMode(Batched);
+    setBatchSize(1'000);
+}
+
+void SmythWordList::copy() {
+    auto rows = selectionModel()->selectedRows();
+    if (rows.empty()) return;
+    rgs::sort(rows, {}, &QModelIndex::row);
+
+    QString text;
+    for (auto& r : rows) {
+        text += model.word(usz(r.row()));
+        text += '\n';
+    }
+
+    QGuiApplication::clipboard()->setText(text);
+}
+
+void SmythWordList::keyPressEvent(QKeyEvent* event) {
+    if (HandleZoomEvent(event)) return;
+    if (event->matches(QKeySequence::Copy)) {
+        copy();
+        event->accept();
+        return;
+    }
+
+    QListView::keyPressEvent(event);
+}
+
+void SmythWordList::setPlainText(const QString& text) {
+    model.reset(text);
+}
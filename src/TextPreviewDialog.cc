@@ -1,3 +1,4 @@
+#include <QTableWidgetItem>
 #include <UI/TextPreviewDialog.hh>
 #include <ui_TextPreviewDialog.h>
 
@@ -12,11 +13,24 @@ void smyth::ui::TextPreviewDialog::Show(
     const QString& title,
     const QString& text,
     const QFont& font,
-    QWidget* parent
+    QWidget* parent,
+    const Table& table
 ) {
     TextPreviewDialog dialog{parent};
     dialog.ui->contents->setPlainText(text);
     dialog.ui->contents->setFont(font);
+
+    // Only show the table if there is anything in it.
+    auto details = dialog.ui->details;
+    details->setVisible(not table.rows.empty());
+    details->setColumnCount(int(table.headers.size()));
+    details->setHorizontalHeaderLabels(table.headers);
+    details->setRowCount(int(table.rows.size()));
+    for (auto [row, cells] : table.rows | vws::enumerate)
+        for (auto [col, cell] : cells | vws::enumerate)
+            details->setItem(int(row), int(col), new QTableWidgetItem(cell));
+    details->resizeColumnsToContents();
+
     dialog.setWindowTitle(title);
     dialog.setWindowFlags(Qt::Dialog | Qt::WindowTitleHint);
     dialog.exec();
@@ -0,0 +1,162 @@
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <QFile>
+#include <Smyth/JSON.hh>
+#include <Smyth/Trace.hh>
+
+using namespace smyth;
+using namespace smyth::trace;
+using json = json_utils::json;
+
+namespace {
+/// Don’t let the history grow without bounds.
+constexpr usz MaxSpans = 100'000;
+constexpr usz MaxRuns = 100;
+
+struct Span {
+    std::string_view name;
+    Clock::time_point start;
+    Clock::time_point end;
+    u64 thread;
+    RunId run;
+};
+
+struct RunInfo {
+    RunId id;
+    std::string_view name;
+    Clock::time_point start;
+    std::optional<Clock::time_point> end;
+};
+
+struct History {
+    std::mutex lock;
+    std::deque<Span> spans;
+    std::deque<RunInfo> runs;
+    RunId next_id = 1;
+
+    /// Timestamps in the trace file are relative to this.
+    const Clock::time_point epoch = Clock::now();
+};
+
+History Trace;
+
+/// The run that is current on this thread.
+thread_local RunId Current = 0;
+
+/// Get a small number that identifies the current thread.
+auto ThreadId() -> u64 {
+    static std::atomic<u64> next = 1;
+    thread_local u64 id = next++;
+    return id;
+}
+
+/// Convert a time point to microseconds since the epoch.
+auto Micros(Clock::time_point t) -> double {
+    return std::chrono::duration<double, std::micro>(t - Trace.epoch).count();
+}
+} // namespace
+
+Timer::~Timer() {
+    Record(name, start);
+}
+
+Scope::Scope(RunId run) : previous{std::exchange(Current, run)} {}
+Scope::~Scope() { Current = previous; }
+
+Run::Run(std::string_view name) : run_id{BeginRun(name)} {}
+Run::~Run() {
+    if (not ended) EndRun(run_id);
+}
+
+auto Run::end() -> Breakdown {
+    ended = true;
+    return EndRun(run_id);
+}
+
+auto trace::BeginRun(std::string_view name) -> RunId {
+    std::unique_lock _{Trace.lock};
+    auto id = Trace.next_id++;
+    Trace.runs.push_back(RunInfo{id, name, Clock::now(), std::nullopt});
+    if (Trace.runs.size() > MaxRuns) Trace.runs.pop_front();
+    return id;
+}
+
+auto trace::CurrentRun() -> RunId {
+    return Current;
+}
+
+auto trace::EndRun(RunId run) -> Breakdown {
+    std::unique_lock _{Trace.lock};
+    Breakdown b;
+    auto r = rgs::find(Trace.runs, run, &RunInfo::id);
+    if (r == Trace.runs.end() or r->end) return b;
+    r->end = Clock::now();
+    b.total = *r->end - r->start;
+
+    // Spans are recorded in the order they end, so the ones for this run
+    // can’t be older than the run itself; search from the back.
+    auto first = rgs::find_if(Trace.spans.rbegin(), Trace.spans.rend(), [&](const Span& s) {
+        return s.end < r->start;
+    }).base();
+
+    for (const auto& s : rgs::subrange(first, Trace.spans.end())) {
+        if (s.run != run) continue;
+        auto it = rgs::find(b.stages, s.name, &std::pair<std::string_view, Clock::duration>::first);
+        if (it == b.stages.end()) b.stages.emplace_back(s.name, s.end - s.start);
+        else it->second += s.end - s.start;
+    }
+
+    return b;
+}
+
+auto trace::ExportChromeTrace(const QString& path) -> Result<> {
+    json events = json::array();
+    {
+        std::unique_lock _{Trace.lock};
+        for (const auto& r : Trace.runs) {
+            if (not r.end) continue;
+            events.push_back({
+                {"name", r.name},
+                {"cat", "run"},
+                {"ph", "X"},
+                {"ts", Micros(r.start)},
+                {"dur", Micros(*r.end) - Micros(r.start)},
+                {"pid", 1},
+                {"tid", 0},
+                {"args", {{"run", r.id}}},
+            });
+        }
+
+        for (const auto& s : Trace.spans) {
+            events.push_back({
+                {"name", s.name},
+                {"cat", "stage"},
+                {"ph", "X"},
+                {"ts", Micros(s.start)},
+                {"dur", Micros(s.end) - Micros(s.start)},
+                {"pid", 1},
+                {"tid", s.thread},
+                {"args", {{"run", s.run}}},
+            });
+        }
+    }
+
+    json j{
+        {"traceEvents", std::move(events)},
+        {"displayTimeUnit", "ms"},
+    };
+
+    QFile f{path};
+    if (not f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return Error("Could not open file '{}'", path.toStdString());
+    if (f.write(QByteArray::fromStdString(j.dump())) == -1) return Error("Failed to write trace: {}", f.errorString().toStdString());
+    return {};
+}
+
+void trace::Record(std::string_view name, Clock::time_point start, Clock::time_point end, RunId run) {
+    auto thread = ThreadId();
+    std::unique_lock _{Trace.lock};
+    Trace.spans.push_back(Span{name, start, end, thread, run});
+    if (Trace.spans.size() > MaxSpans) Trace.spans.pop_front();
+}
@@ -0,0 +1,142 @@
+#include <future>
+#include <Smyth/Unicode.hh>
+#include <thread>
+#include <unicode/unorm2.h>
+
+using namespace smyth;
+
+namespace {
+/// Don’t bother with threads for texts shorter than this.
+constexpr qsizetype MinCharsPerChunk = 1 << 16;
+
+auto Data(QStringView s) -> const UChar* {
+    return reinterpret_cast<const UChar*>(s.utf16());
+}
+
+auto Data(QString& s) -> UChar* {
+    return reinterpret_cast<UChar*>(s.data());
+}
+
+auto GetNormaliser(text::NormalisationForm form) -> Result<const UNormalizer2*> {
+    UErrorCode err = U_ZERO_ERROR;
+    const UNormalizer2* n = nullptr;
+    switch (form) {
+        case text::NormalisationForm::NFC: n = unorm2_getNFCInstance(&err); break;
+        case text::NormalisationForm::NFD: n = unorm2_getNFDInstance(&err); break;
+        default: return Error("Unsupported normalisation form");
+    }
+
+    if (U_FAILURE(err)) return Error("Failed to get normaliser: {}", u_errorName(err));
+    return n;
+}
+
+/// Normalise a piece of text that starts and ends at a normalisation
+/// boundary, and append the result to a string.
+auto NormaliseChunk(const UNormalizer2* n, QStringView in, QString& out) -> Result<> {
+    // Normalisation rarely changes the length by much, so start with
+    // a bit of extra room and only retry if that wasn’t enough.
+    auto offs = out.size();
+    auto capacity = in.size() + in.size() / 8 + 16;
+    for (;;) {
+        UErrorCode err = U_ZERO_ERROR;
+        out.resize(offs + capacity);
+        auto len = unorm2_normalize(
+            n,
+            Data(in),
+            int32_t(in.size()),
+            Data(out) + offs,
+            int32_t(capacity),
+            &err
+        );
+
+        if (err == U_BUFFER_OVERFLOW_ERROR) {
+            capacity = len;
+            continue;
+        }
+
+        if (U_FAILURE(err)) return Error("Normalisation failed: {}", u_errorName(err));
+        out.resize(offs + len);
+        return {};
+    }
+}
+} // namespace
+
+auto smyth::Fold(QStringView text) -> Result<QString> {
+    UErrorCode err = U_ZERO_ERROR;
+    auto n = unorm2_getNFKDInstance(&err);
+    if (U_FAILURE(err)) return Error("Failed to get normaliser: {}", u_errorName(err));
+
+    // Fold case first since that may introduce combining marks (e.g.
+    // ‘İ’ folds to ‘i’ followed by a combining dot).
+    auto folded = text.toString().toCaseFolded();
+    QString decomposed;
+    Try(NormaliseChunk(n, folded, decomposed));
+
+    // Then, drop all combining marks.
+    QString out;
+    out.reserve(decomposed.size());
+    for (qsizetype i = 0; i < decomposed.size(); i++) {
+        auto c = decomposed[i];
+        if (c.isHighSurrogate() and i + 1 < decomposed.size() and decomposed[i + 1].isLowSurrogate()) {
+            auto low = decomposed[++i];
+            if (not QChar::isMark(QChar::surrogateToUcs4(c, low))) {
+                out += c;
+                out += low;
+            }
+        } else if (not c.isMark()) {
+            out += c;
+        }
+    }
+
+    return out;
+}
+
+auto smyth::Normalise(QString& text, text::NormalisationForm form) -> Result<> {
+    if (form == text::NormalisationForm::None or text.isEmpty()) return {};
+    auto n = Try(GetNormaliser(form));
+
+    // Find the longest prefix that is definitely normalised already; in
+    // the common case, this is the entire string, and we’re done.
+    UErrorCode err = U_ZERO_ERROR;
+    auto normalised = qsizetype(unorm2_spanQuickCheckYes(n, Data(QStringView{text}), int32_t(text.size()), &err));
+    if (U_FAILURE(err)) return Error("Normalisation failed: {}", u_errorName(err));
+    if (normalised == text.size()) return {};
+
+    // The prefix ends at a normalisation boundary, so we can keep it as is
+    // and only normalise the rest. Line breaks are boundaries too, so split
+    // the rest at those if there is enough of it.
+    QStringView rest = QStringView{text}.sliced(normalised);
+    auto threads = qsizetype(std::max(1u, std::thread::hardware_concurrency()));
+    auto chunks = std::clamp<qsizetype>(rest.size() / MinCharsPerChunk, 1, threads);
+    std::vector<QStringView> parts;
+    for (qsizetype i = 0; i < chunks - 1 and not rest.isEmpty(); i++) {
+        auto nl = rest.indexOf('\n', rest.size() / (chunks - i));
+        if (nl == -1) break;
+        parts.push_back(rest.first(nl + 1));
+        rest = rest.sliced(nl + 1);
+    }
+    parts.push_back(rest);
+
+    // Normalise the chunks; the first one is done on this thread.
+    QString out;
+    out.reserve(text.size() + text.size() / 8);
+    out += QStringView{text}.first(normalised);
+    if (parts.size() == 1) {
+        Try(NormaliseChunk(n, parts.front(), out));
+    } else {
+        std::vector<std::future<Result<QString>>> futures;
+        for (auto p : parts | vws::drop(1)) {
+            futures.push_back(std::async(std::launch::async, [n, p] -> Result<QString> {
+                QString s;
+                Try(NormaliseChunk(n, p, s));
+                return s;
+            }));
+        }
+
+        Try(NormaliseChunk(n, parts.front(), out));
+        for (auto& f : futures) out += Try(f.get());
+    }
+
+    text = std::move(out);
+    return {};
+}
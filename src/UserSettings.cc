@@ -11,6 +11,12 @@ UserSetting<QFont> settings::MonoFont{"mono.font", QFont{"monospace"}};
 UserSetting<QFont> settings::SerifFont{"serif.font", QFont{"serif"}};
 UserSetting<QFont> settings::SansFont{"sans.font", QFont{"sans"}};
 UserSetting<> settings::LastOpenProject{"last_open_project", ""};
+UserSetting<int> settings::LexurgyServers{"lexurgy.servers", 1};
+UserSetting<bool> settings::NativeEngine{"sca.native_engine", false};
+
+#ifdef SMYTH_LEXURGY_JNI
+UserSetting<bool> settings::LexurgyInProcess{"lexurgy.in_process", false};
+#endif
 
 #ifdef LIBBASE_DEBUG
 UserSetting<bool> settings::DumpJsonRequests{"__debug__/dump_json_requests", false};
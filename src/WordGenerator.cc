@@ -0,0 +1,750 @@
+#include <future>
+#include <map>
+#include <numeric>
+#include <QHash>
+#include <random>
+#include <optional>
+#include <Smyth/Philox.hh>
+#include <Smyth/Unicode.hh>
+#include <Smyth/WordGenerator.hh>
+#include <Smyth/WordIndex.hh>
+#include <thread>
+#include <UI/Utils.hh>
+
+using namespace smyth;
+using namespace smyth::wordgen;
+
+namespace {
+/// Don’t bother with threads for fewer words than this.
+constexpr usz MinWordsPerChunk = 16'384;
+
+/// Give up on a word after this many rejected candidates.
+constexpr u32 MaxAttempts = 1'000;
+
+/// Characters that have a special meaning in patterns.
+constexpr QStringView Syntax = u"()[]|";
+
+/// Pick a random number in [0, n).
+template <typename Rng>
+auto Pick(Rng& rng, u32 n) -> u32 {
+    static_assert(Rng::min() == 0 and Rng::max() == std::numeric_limits<u32>::max());
+    return u32((u64(rng()) * n) >> 32);
+}
+
+/// Parse the weight of a class member or alternative.
+auto ParseWeight(QStringView text) -> Result<double> {
+    bool ok = false;
+    auto w = text.trimmed().toDouble(&ok);
+    if (not ok or not std::isfinite(w) or w <= 0) return Error(
+        "Invalid weight '{}'; weights must be positive numbers",
+        text.trimmed().toString()
+    );
+    return w;
+}
+
+/// Split the items in [0, count) into chunks and process them in
+/// parallel; the first chunk is done on this thread. Returns the result
+/// of processing each chunk, in order.
+template <typename Callable>
+auto RunInChunks(usz count, Callable run) {
+    using Chunk = std::invoke_result_t<Callable, usz, usz>;
+    auto threads = usz(std::max(1u, std::thread::hardware_concurrency()));
+    auto chunks = std::clamp<usz>(count / MinWordsPerChunk, 1, threads);
+    auto chunk_size = (count + chunks - 1) / chunks;
+    std::vector<std::future<Chunk>> futures;
+    for (usz i = 1; i < chunks; i++) {
+        auto from = std::min(i * chunk_size, count);
+        auto to = std::min(from + chunk_size, count);
+        futures.push_back(std::async(std::launch::async, run, from, to));
+    }
+
+    std::vector<Chunk> results;
+    results.push_back(run(0, std::min(chunk_size, count)));
+    for (auto& f : futures) results.push_back(f.get());
+    return results;
+}
+
+/// Generate words, one per line.
+///
+/// ‘candidate(w, a, out, picks)’ appends the a-th candidate for the w-th
+/// word to ‘out’, adds the class members it picked to ‘picks’, and returns
+/// false if the candidate is rejected by filters. Every word is the first
+/// of its candidates that isn’t rejected and, if ‘exclude’ is set, that
+/// isn’t a duplicate of a word in ‘exclude’ or an earlier word in this
+/// batch. This only depends on the candidates, and not on how the work
+/// is split up between threads.
+///
+/// Generation stops at the first word for which every candidate is
+/// rejected.
+template <typename Candidate>
+auto Produce(
+    usz count,
+    usz items,
+    const WordIndex* exclude,
+    Candidate candidate
+) -> Result<Generator::Words> {
+    using Words = Generator::Words;
+    struct Found {
+        u32 attempt;
+        QString folded;
+    };
+
+    // Find the first acceptable candidate for word ‘w’, starting at
+    // attempt ‘first’, and append it to ‘out’.
+    auto Find = [&](
+        usz w,
+        u32 first,
+        Words& out,
+        std::vector<u32>& picks,
+        WordIndex* batch
+    ) -> Result<std::optional<Found>> {
+        for (auto a = first; a < MaxAttempts; a++) {
+            auto size = out.text.size();
+            picks.clear();
+            if (not candidate(w, a, out.text, picks)) {
+                out.text.truncate(size);
+                out.rejected++;
+                continue;
+            }
+
+            QString folded;
+            if (exclude) {
+                folded = Try(Fold(QStringView{out.text}.sliced(size)));
+                if (exclude->contains(folded) or (batch and batch->contains(folded))) {
+                    out.text.truncate(size);
+                    out.duplicates++;
+                    continue;
+                }
+
+                if (batch) batch->insert(folded);
+            }
+
+            out.text += '\n';
+            for (auto p : picks) out.draws[p]++;
+            return std::optional{Found{a, std::move(folded)}};
+        }
+
+        return std::optional<Found>{};
+    };
+
+    // Generating and folding the words and looking them up in ‘exclude’ is
+    // most of the work, so that is done in parallel; every chunk gets its
+    // own counts so the threads don’t have to share any state.
+    struct Chunk {
+        usz from;
+        Words words;
+        std::vector<u32> attempts{};
+        std::vector<QString> folded{};
+        bool complete = true;
+    };
+
+    auto Run = [&](usz from, usz to) -> Result<Chunk> {
+        Chunk c{.from = from, .words = {.text = {}, .draws = std::vector<u64>(items)}};
+        c.words.text.reserve(qsizetype(to - from) * 8);
+        std::vector<u32> picks;
+        for (auto w = from; w < to; w++) {
+            auto found = Try(Find(w, 0, c.words, picks, nullptr));
+            if (not found) {
+                c.complete = false;
+                break;
+            }
+
+            if (exclude) {
+                c.attempts.push_back(found->attempt);
+                c.folded.push_back(std::move(found->folded));
+            }
+        }
+
+        return c;
+    };
+
+    // Merge the chunks, stopping after the first incomplete one. Words
+    // that occur earlier in the batch are replaced here since that has
+    // to happen in order; this is rare unless there are few possible
+    // words to begin with.
+    auto chunks = RunInChunks(count, Run);
+    Words out{.text = {}, .draws = std::vector<u64>(items)};
+    out.text.reserve(qsizetype(count) * 8);
+    WordIndex batch{exclude ? count : 0};
+    std::vector<u32> picks;
+    for (auto& r : chunks) {
+        auto c = Try(std::move(r));
+        out.rejected += c.words.rejected;
+        out.duplicates += c.words.duplicates;
+        for (auto [total, n] : vws::zip(out.draws, c.words.draws)) total += n;
+        if (not exclude) {
+            out.text += c.words.text;
+            if (not c.complete) break;
+            continue;
+        }
+
+        QStringView text = c.words.text;
+        for (usz i = 0; i < c.folded.size(); i++) {
+            auto word = text.first(text.indexOf('\n') + 1);
+            text = text.sliced(word.size());
+            if (not batch.contains(c.folded[i])) {
+                batch.insert(std::move(c.folded[i]));
+                out.text += word;
+                continue;
+            }
+
+            // Discard the word; generate it again to find out what class
+            // members it picked so we don’t count them.
+            QString discarded;
+            picks.clear();
+            out.duplicates++;
+            candidate(c.from + i, c.attempts[i], discarded, picks);
+            for (auto p : picks) out.draws[p]--;
+            if (not Try(Find(c.from + i, c.attempts[i] + 1, out, picks, &batch))) return out;
+        }
+
+        if (not c.complete) break;
+    }
+
+    return out;
+}
+} // namespace
+
+auto wordgen::RandomSeed() -> u64 {
+    std::random_device rd;
+    return u64(rd()) << 32 | rd();
+}
+
+// ====================================================================
+//  Parser
+// ====================================================================
+class Generator::Parser {
+    /// An element of a pattern.
+    struct Element {
+        enum struct Kind : u8 {
+            Class,
+            Optional,
+            Choice,
+        };
+
+        Kind kind;
+        u32 cls = 0;
+
+        /// Optional: the optional part; Choice: the alternatives.
+        std::vector<std::vector<Element>> branches;
+
+        /// Choice: the weight of each alternative.
+        std::vector<double> weights;
+    };
+
+    using Sequence = std::vector<Element>;
+
+    Generator& g;
+    QStringView pattern;
+    qsizetype pos = 0;
+    QHash<QChar, u32> class_indices;
+
+public:
+    Parser(Generator& g, QStringView pattern) : g{g}, pattern{pattern} {}
+
+    /// Parse class definitions.
+    auto ParseClasses(QStringView text) -> Result<>;
+
+    /// Parse the pattern and compile it.
+    auto ParsePattern() -> Result<>;
+
+private:
+    auto AddClass(QChar name, QStringView items) -> Result<>;
+    auto AddFilters(QStringView strings) -> Result<>;
+    auto Build(const Sequence& seq, u32 next) -> u32;
+    auto BuildElement(const Element& e, u32 next) -> u32;
+    void BuildFilter();
+    auto Literal(QChar c) -> u32;
+    auto ParseSequence(bool in_choice = false) -> Result<Sequence>;
+
+    /// Check whether a sequence can produce nothing at all.
+    static bool Nullable(const Sequence& seq);
+};
+
+auto Generator::Parser::AddClass(QChar name, QStringView items) -> Result<> {
+    if (class_indices.contains(name)) return Error("Class '{}' is defined more than once", QString{name});
+    Class cls{name, u32(g.items.size()), 0, false};
+    std::vector<double> weights;
+    for (auto item : items.split(',')) {
+        item = item.trimmed();
+        double weight = 1;
+        if (auto colon = item.lastIndexOf(':'); colon != -1) {
+            weight = Try(ParseWeight(item.sliced(colon + 1)));
+            item = item.first(colon).trimmed();
+        }
+
+        if (item.isEmpty()) return Error("Class '{}' contains an empty item", QString{name});
+        g.items.push_back(Item{u32(g.pool.size()), u32(item.size()), weight});
+        g.pool += item;
+        weights.push_back(weight);
+        cls.count++;
+    }
+
+    // Only bother with an alias table if the weights actually differ.
+    g.item_aliases.resize(g.items.size());
+    if (rgs::any_of(weights, [&](double w) { return w != weights.front(); })) {
+        cls.weighted = true;
+        BuildAliasTable(weights, std::span{g.item_aliases}.subspan(cls.first, cls.count));
+    }
+
+    class_indices[name] = u32(g.classes.size());
+    g.classes.push_back(cls);
+    return {};
+}
+
+auto Generator::Parser::AddFilters(QStringView strings) -> Result<> {
+    for (auto str : strings.split(',')) {
+        str = str.trimmed();
+        if (str.isEmpty()) return Error("Filters must not be empty");
+
+        // Add the string to the trie.
+        u32 state = 0;
+        for (auto c : str) {
+            if (auto it = g.filter[state].next.find(c); it != g.filter[state].next.end()) {
+                state = *it;
+                continue;
+            }
+
+            auto next = u32(g.filter.size());
+            g.filter[state].next[c] = next;
+            g.filter.emplace_back();
+            state = next;
+        }
+
+        g.filter[state].match = true;
+    }
+
+    return {};
+}
+
+auto Generator::Parser::Build(const Sequence& seq, u32 next) -> u32 {
+    for (const auto& e : seq | vws::reverse) next = BuildElement(e, next);
+    return next;
+}
+
+auto Generator::Parser::BuildElement(const Element& e, u32 next) -> u32 {
+    if (e.kind == Element::Kind::Class) {
+        g.nodes.push_back(Node{Node::Kind::Emit, false, e.cls, 0, next});
+        return u32(g.nodes.size() - 1);
+    }
+
+    // Build the branches first since the targets of a node must be
+    // contiguous.
+    std::vector<u32> entries;
+    for (const auto& b : e.branches) entries.push_back(Build(b, next));
+    if (e.kind == Element::Kind::Optional) entries.push_back(next);
+
+    auto first = g.targets.size();
+    auto weighted = rgs::any_of(e.weights, [&](double w) { return w != e.weights.front(); });
+    g.nodes.push_back(Node{Node::Kind::Choose, weighted, u32(first), u32(entries.size()), 0});
+    g.targets.insert(g.targets.end(), entries.begin(), entries.end());
+    g.target_aliases.resize(g.targets.size());
+    if (weighted) BuildAliasTable(e.weights, std::span{g.target_aliases}.subspan(first, entries.size()));
+    return u32(g.nodes.size() - 1);
+}
+
+void Generator::Parser::BuildFilter() {
+    // Compute failure links breadth-first so that those of the states
+    // we fall back to are already known; a state also matches if the
+    // state it falls back to matches, since that is a suffix of it.
+    std::vector<u32> queue{0};
+    for (usz i = 0; i < queue.size(); i++) {
+        auto u = queue[i];
+        auto next = g.filter[u].next;
+        for (auto [c, v] : next.asKeyValueRange()) {
+            g.filter[v].fail = u == 0 ? 0 : g.FilterStep(g.filter[u].fail, c);
+            g.filter[v].match |= g.filter[g.filter[v].fail].match;
+            queue.push_back(v);
+        }
+    }
+}
+
+auto Generator::Parser::Literal(QChar c) -> u32 {
+    // Literals are classes with a single member and without a name.
+    g.items.push_back(Item{u32(g.pool.size()), 1, 1});
+    g.item_aliases.emplace_back();
+    g.pool += c;
+    g.classes.push_back(Class{QChar{}, u32(g.items.size() - 1), 1, false});
+    return u32(g.classes.size() - 1);
+}
+
+auto Generator::Parser::ParseClasses(QStringView text) -> Result<> {
+    for (auto line : text.split('\n')) {
+        line = line.trimmed();
+        if (line.isEmpty()) continue;
+        if (line.startsWith(u"reject:")) {
+            Try(AddFilters(line.sliced(7)));
+            continue;
+        }
+
+        auto eq = line.indexOf('=');
+        if (eq == -1) return Error("Invalid class definition '{}'; expected 'C = a, b, c'", line.toString());
+        auto name = line.first(eq).trimmed();
+        if (name.size() != 1 or name[0].isSpace() or Syntax.contains(name[0])) return Error(
+            "Invalid class name '{}'; class names must be a single character",
+            name.toString()
+        );
+
+        Try(AddClass(name[0], line.sliced(eq + 1)));
+    }
+
+    BuildFilter();
+    return {};
+}
+
+auto Generator::Parser::ParsePattern() -> Result<> {
+    auto seq = Try(ParseSequence());
+    if (pos != pattern.size()) return Error("Unexpected '{}' in pattern", QString{pattern[pos]});
+    if (seq.empty()) return Error("Pattern is empty");
+
+    // Reject this here rather than skipping empty words when generating
+    // them so that what we generate is what we count.
+    if (Nullable(seq)) return Error("Pattern can generate empty words; at least one part of it must not be optional");
+
+    g.nodes.push_back(Node{Node::Kind::Accept, false, 0, 0, 0});
+    g.start = Build(seq, 0);
+    return {};
+}
+
+bool Generator::Parser::Nullable(const Sequence& seq) {
+    return rgs::all_of(seq, [](const Element& e) {
+        switch (e.kind) {
+            case Element::Kind::Class: return false;
+            case Element::Kind::Optional: return true;
+            case Element::Kind::Choice: return rgs::any_of(e.branches, Nullable);
+        }
+        return false;
+    });
+}
+
+auto Generator::Parser::ParseSequence(bool in_choice) -> Result<Sequence> {
+    Sequence seq;
+    while (pos < pattern.size()) {
+        auto c = pattern[pos];
+        if (c.isSpace()) {
+            pos++;
+            continue;
+        }
+
+        // Let the caller handle the end of a group and weights.
+        if (c == ')' or c == ']' or c == '|') break;
+        if (c == ':' and in_choice) break;
+
+        // Optional part.
+        if (c == '(') {
+            pos++;
+            Element e{Element::Kind::Optional};
+            e.branches.push_back(Try(ParseSequence()));
+            if (pos == pattern.size() or pattern[pos] != ')') return Error("Missing ')' in pattern");
+            pos++;
+            seq.push_back(std::move(e));
+            continue;
+        }
+
+        // Alternatives.
+        if (c == '[') {
+            pos++;
+            Element e{Element::Kind::Choice};
+            for (;;) {
+                e.branches.push_back(Try(ParseSequence(true)));
+                e.weights.push_back(1);
+                if (pos != pattern.size() and pattern[pos] == ':') {
+                    auto end = ++pos;
+                    while (end < pattern.size() and pattern[end] != '|' and pattern[end] != ']') end++;
+                    e.weights.back() = Try(ParseWeight(pattern.sliced(pos, end - pos)));
+                    pos = end;
+                }
+
+                if (pos == pattern.size()) return Error("Missing ']' in pattern");
+                if (pattern[pos++] == ']') break;
+                if (pattern[pos - 1] != '|') return Error("Unexpected '{}' in pattern", QString{pattern[pos - 1]});
+            }
+
+            seq.push_back(std::move(e));
+            continue;
+        }
+
+        // Class or literal.
+        pos++;
+        auto it = class_indices.find(c);
+        seq.push_back(Element{Element::Kind::Class, it != class_indices.end() ? *it : Literal(c)});
+    }
+
+    return seq;
+}
+
+// ====================================================================
+//  Generator
+// ====================================================================
+auto Generator::Compile(QStringView classes, QStringView pattern) -> Result<Generator> {
+    Generator g;
+    Parser p{g, pattern};
+    Try(p.ParseClasses(classes));
+    Try(p.ParsePattern());
+    return g;
+}
+
+void Generator::BuildAliasTable(std::span<const double> weights, std::span<Alias> table) {
+    // Scale the weights so they average to 1; every entry is then filled
+    // up to 1 by taking the remainder from an entry that is above that.
+    auto n = weights.size();
+    auto sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    std::vector<double> scaled(n);
+    std::vector<u32> small, large;
+    for (usz i = 0; i < n; i++) {
+        scaled[i] = weights[i] * double(n) / sum;
+        (scaled[i] < 1 ? small : large).push_back(u32(i));
+    }
+
+    while (not small.empty() and not large.empty()) {
+        auto s = small.back();
+        auto l = large.back();
+        small.pop_back();
+        large.pop_back();
+        table[s] = Alias{u64(std::ldexp(scaled[s], 32)), l};
+        scaled[l] -= 1 - scaled[s];
+        (scaled[l] < 1 ? small : large).push_back(l);
+    }
+
+    // Whatever is left is 1, up to rounding errors.
+    for (auto i : small) table[i] = Alias{u64(1) << 32, i};
+    for (auto i : large) table[i] = Alias{u64(1) << 32, i};
+}
+
+auto Generator::frequencies(std::span<const u64> draws) const -> std::vector<Frequency> {
+    std::vector<Frequency> out;
+    for (const auto& cls : classes) {
+        if (cls.name.isNull()) continue;
+        auto members = std::span{items}.subspan(cls.first, cls.count);
+        auto counts = draws.subspan(cls.first, cls.count);
+        auto total_weight = std::accumulate(members.begin(), members.end(), 0.0, [](double sum, const Item& i) { return sum + i.weight; });
+        auto total_draws = std::accumulate(counts.begin(), counts.end(), u64(0));
+        if (total_draws == 0) continue;
+        for (auto [item, count] : vws::zip(members, counts)) {
+            out.push_back(Frequency{
+                .cls = cls.name,
+                .member = QStringView{pool}.sliced(item.offset, item.size).toString(),
+                .expected = item.weight / total_weight,
+                .actual = double(count) / double(total_draws),
+                .draws = count,
+            });
+        }
+    }
+
+    return out;
+}
+
+auto Generator::FilterStep(u32 state, QChar c) const -> u32 {
+    for (;;) {
+        const auto& s = filter[state];
+        if (auto it = s.next.find(c); it != s.next.end()) return *it;
+        if (state == 0) return 0;
+        state = s.fail;
+    }
+}
+
+template <typename Rng>
+void Generator::Generate(Rng& rng, QString& out, std::vector<u32>& picks) const {
+    for (auto n = start;;) {
+        const auto& node = nodes[n];
+        switch (node.kind) {
+            case Node::Kind::Accept:
+                return;
+
+            case Node::Kind::Emit: {
+                const auto& cls = classes[node.index];
+                auto i = cls.first + (cls.count == 1 ? 0 : Pick(rng, cls.count));
+                if (cls.weighted and u64(rng()) >= item_aliases[i].threshold) i = cls.first + item_aliases[i].other;
+                out += QStringView{pool}.sliced(items[i].offset, items[i].size);
+                picks.push_back(i);
+                n = node.next;
+            } break;
+
+            case Node::Kind::Choose: {
+                auto i = node.index + Pick(rng, node.count);
+                if (node.weighted and u64(rng()) >= target_aliases[i].threshold) i = node.index + target_aliases[i].other;
+                n = targets[i];
+            } break;
+        }
+    }
+}
+
+auto Generator::generate(usz count, u64 seed, const WordIndex* exclude) const -> Result<Words> {
+    // Every candidate gets its own random stream, so the words only
+    // depend on the seed, not on how they’re split up between threads.
+    count = std::min(count, MaxWords);
+    return Produce(count, items.size(), exclude, [this, seed](usz w, u32 a, QString& out, std::vector<u32>& picks) {
+        Philox rng{seed, w, a};
+        auto size = out.size();
+        Generate(rng, out, picks);
+        return not Rejected(QStringView{out}.sliced(size));
+    });
+}
+
+auto Generator::Rejected(QStringView word) const -> bool {
+    if (not has_filters()) return false;
+    u32 state = 0;
+    for (auto c : word) {
+        state = FilterStep(state, c);
+        if (filter[state].match) return true;
+    }
+
+    return false;
+}
+
+auto Generator::space(bool filtered) const -> Result<WordSpace> {
+    // Every character of every member of the class of an Emit node is a
+    // state of a nondeterministic automaton; after the last character of
+    // a member, we continue at the node after the Emit node. Position 0
+    // means that the word is complete.
+    struct Position {
+        QChar c;
+        bool last;
+        u32 next;
+    };
+
+    // Compute the positions we can be at when we enter each node; this
+    // is simple since nodes only ever refer to nodes that were created
+    // before them.
+    std::vector<Position> positions(1);
+    std::vector<std::vector<u32>> closures(nodes.size());
+    for (usz n = 0; n < nodes.size(); n++) {
+        const auto& node = nodes[n];
+        auto& closure = closures[n];
+        if (node.kind == Node::Kind::Accept) {
+            closure.push_back(0);
+        } else if (node.kind == Node::Kind::Emit) {
+            const auto& cls = classes[node.index];
+            for (const auto& item : std::span{items}.subspan(cls.first, cls.count)) {
+                closure.push_back(u32(positions.size()));
+                for (u32 i = 0; i < item.size; i++) positions.push_back(Position{
+                    pool[item.offset + i],
+                    i + 1 == item.size,
+                    node.next,
+                });
+            }
+        } else {
+            for (auto t : std::span{targets}.subspan(node.index, node.count)) {
+                Assert(t < n, "Node refers to a later node");
+                closure.insert(closure.end(), closures[t].begin(), closures[t].end());
+            }
+
+            rgs::sort(closure);
+            closure.erase(std::unique(closure.begin(), closure.end()), closure.end());
+        }
+    }
+
+    // Determinise the automaton; if we’re filtering, every state is also
+    // paired with a state of the filter automaton, and we drop transitions
+    // that would complete a rejected string.
+    using Key = std::pair<u32, std::vector<u32>>;
+    WordSpace s;
+    std::map<Key, u32> ids;
+    std::vector<Key> pending;
+    auto Intern = [&](u32 filter_state, std::vector<u32> set) {
+        auto [it, inserted] = ids.try_emplace(Key{filter_state, set}, u32(pending.size()));
+        if (inserted) pending.emplace_back(filter_state, std::move(set));
+        return it->second;
+    };
+
+    Intern(0, closures[start]);
+    std::map<char16_t, std::vector<u32>> moves;
+    for (usz i = 0; i < pending.size(); i++) {
+        if (pending.size() > WordSpace::MaxStates) return Error(
+            "Pattern is too complex to count the words it generates"
+        );
+
+        moves.clear();
+        auto filter_state = pending[i].first;
+        for (auto p : pending[i].second) {
+            if (p == 0) continue;
+            auto& m = moves[positions[p].c.unicode()];
+            if (not positions[p].last) m.push_back(p + 1);
+            else m.insert(m.end(), closures[positions[p].next].begin(), closures[positions[p].next].end());
+        }
+
+        WordSpace::State state{u32(s.transitions.size()), 0, pending[i].second.front() == 0};
+        for (auto& [c, set] : moves) {
+            auto next_filter_state = filtered ? FilterStep(filter_state, QChar{c}) : 0;
+            if (filter[next_filter_state].match) continue;
+            rgs::sort(set);
+            set.erase(std::unique(set.begin(), set.end()), set.end());
+            s.transitions.push_back(WordSpace::Transition{QChar{c}, Intern(next_filter_state, std::move(set))});
+        }
+
+        state.count = u32(s.transitions.size() - state.first);
+        s.states.push_back(state);
+    }
+
+    // Count the words.
+    s.ways.resize(s.states.size());
+    s.Count(0);
+    s.by_length = s.ways[0];
+    while (not s.by_length.empty() and s.by_length.back().is_zero()) s.by_length.pop_back();
+    for (const auto& n : s.by_length) s.total += n;
+    return s;
+}
+
+// ====================================================================
+//  Word Space
+// ====================================================================
+void WordSpace::Count(u32 state) {
+    // The automaton is acyclic since every transition consumes a
+    // character, and the recursion depth is bounded by the maximum
+    // word length.
+    if (not ways[state].empty()) return;
+    std::vector<BigInt> w;
+    w.emplace_back(states[state].accept ? 1 : 0);
+    for (const auto& t : Transitions(state)) {
+        Count(t.target);
+        const auto& tw = ways[t.target];
+        if (w.size() < tw.size() + 1) w.resize(tw.size() + 1);
+        for (usz len = 0; len < tw.size(); len++) w[len + 1] += tw[len];
+    }
+
+    ways[state] = std::move(w);
+}
+
+auto WordSpace::sample(usz count, u64 seed, const WordIndex* exclude) const -> Result<QString> {
+    if (total.is_zero()) return QString{};
+    count = std::min(count, Generator::MaxWords);
+    auto words = Try(Produce(count, 0, exclude, [this, seed](usz w, u32 a, QString& out, std::vector<u32>&) {
+        Philox rng{seed, w, a};
+        out += unrank(BigInt::Below(total, rng));
+        return true;
+    }));
+
+    return std::move(words.text);
+}
+
+auto WordSpace::Transitions(u32 state) const -> std::span<const Transition> {
+    return std::span{transitions}.subspan(states[state].first, states[state].count);
+}
+
+auto WordSpace::unrank(BigInt rank) const -> QString {
+    Assert(rank < total, "Rank out of bounds");
+
+    // Find the length of the word.
+    usz len = 0;
+    while (rank >= by_length[len]) rank -= by_length[len++];
+
+    // Then, walk through the automaton, skipping over all words that
+    // start with a smaller character.
+    QString word;
+    word.reserve(qsizetype(len));
+    for (u32 state = 0; len != 0; len--) {
+        for (const auto& t : Transitions(state)) {
+            const auto& tw = ways[t.target];
+            if (len - 1 >= tw.size()) continue;
+            if (rank < tw[len - 1]) {
+                word += t.c;
+                state = t.target;
+                break;
+            }
+
+            rank -= tw[len - 1];
+        }
+    }
+
+    return word;
+}
@@ -0,0 +1,50 @@
+#include <bit>
+#include <Smyth/Unicode.hh>
+#include <Smyth/WordIndex.hh>
+
+using namespace smyth;
+using namespace smyth::wordgen;
+
+WordIndex::WordIndex(usz expected_size) {
+    words.reserve(qsizetype(expected_size));
+    if (expected_size >= MinBloomWords)
+        bloom.resize(std::bit_ceil(expected_size * BloomBitsPerWord) / 64);
+}
+
+auto WordIndex::Build(const QStringList& words) -> Result<WordIndex> {
+    WordIndex index{usz(words.size())};
+    for (const auto& w : words) {
+        if (w.trimmed().isEmpty()) continue;
+        index.insert(Try(Fold(w.trimmed())));
+    }
+
+    return index;
+}
+
+auto WordIndex::contains(const QString& folded) const -> bool {
+    if (not bloom.empty()) {
+        bool maybe = true;
+        ForEachBit(folded, [&](usz bit) { maybe = maybe and (bloom[bit / 64] >> (bit % 64) & 1); });
+        if (not maybe) return false;
+    }
+
+    return words.contains(folded);
+}
+
+void WordIndex::insert(QString folded) {
+    ForEachBit(folded, [&](usz bit) { bloom[bit / 64] |= u64(1) << (bit % 64); });
+    words.insert(std::move(folded));
+}
+
+template <typename Callable>
+void WordIndex::ForEachBit(const QString& folded, Callable cb) const {
+    if (bloom.empty()) return;
+
+    // Derive all bits from a single hash (Kirsch and Mitzenmacher); the
+    // filter size is a power of two, so we can just mask the index.
+    auto h = u64(qHash(folded));
+    auto h1 = u32(h);
+    auto h2 = u32(h >> 32) | 1;
+    auto mask = bloom.size() * 64 - 1;
+    for (usz i = 0; i < BloomHashes; i++) cb((h1 + i * h2) & mask);
+}
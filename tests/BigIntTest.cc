@@ -0,0 +1,87 @@
+#include <QTest>
+#include <Smyth/BigInt.hh>
+#include <Smyth/Philox.hh>
+
+using namespace smyth;
+
+class BigIntTest : public QObject {
+    Q_OBJECT
+
+    /// Compute 2^n.
+    static auto Pow2(int n) -> BigInt {
+        BigInt b{1};
+        for (int i = 0; i < n; i++) b += b;
+        return b;
+    }
+
+private slots:
+    void prints_numbers();
+    void adds_with_carry();
+    void subtracts_with_borrow();
+    void compares_numbers();
+    void draws_numbers_below_bound();
+};
+
+void BigIntTest::prints_numbers() {
+    QVERIFY(BigInt{}.is_zero());
+    QVERIFY(BigInt{0}.is_zero());
+    QCOMPARE(BigInt{}.str(), std::string{"0"});
+    QCOMPARE(BigInt{7}.str(), std::string{"7"});
+    QCOMPARE(BigInt{1'000'000'007}.str(), std::string{"1000000007"});
+    QCOMPARE(Pow2(100).str(), std::string{"1267650600228229401496703205376"});
+}
+
+void BigIntTest::adds_with_carry() {
+    BigInt max{std::numeric_limits<u64>::max()};
+    QCOMPARE(max.str(), std::string{"18446744073709551615"});
+    QCOMPARE((max + 1).str(), std::string{"18446744073709551616"});
+    QCOMPARE((max + max).str(), std::string{"36893488147419103230"});
+    QCOMPARE(BigInt{0xFFFF'FFFF} + 1, BigInt{0x1'0000'0000});
+    QCOMPARE(BigInt{} + BigInt{}, BigInt{});
+}
+
+void BigIntTest::subtracts_with_borrow() {
+    QCOMPARE(Pow2(64) - 1, BigInt{std::numeric_limits<u64>::max()});
+    QCOMPARE(BigInt{0x1'0000'0000} - 1, BigInt{0xFFFF'FFFF});
+    QCOMPARE((Pow2(100) - 1 + 1).str(), Pow2(100).str());
+    QVERIFY((Pow2(100) - Pow2(100)).is_zero());
+    QCOMPARE(Pow2(100) - Pow2(99), Pow2(99));
+}
+
+void BigIntTest::compares_numbers() {
+    QVERIFY(BigInt{} < BigInt{1});
+    QVERIFY(BigInt{std::numeric_limits<u64>::max()} < Pow2(64));
+    QVERIFY(Pow2(64) > Pow2(63) + Pow2(62));
+    QVERIFY(Pow2(65) - Pow2(64) == Pow2(64));
+    QVERIFY(Pow2(80) + 1 != Pow2(80));
+    QVERIFY(BigInt{5} >= BigInt{5});
+}
+
+void BigIntTest::draws_numbers_below_bound() {
+    Philox rng{1, 0};
+    for (int i = 0; i < 100; i++) QVERIFY(BigInt::Below(1, rng).is_zero());
+
+    // Every number below a small bound should show up.
+    std::array<int, 10> seen{};
+    for (int i = 0; i < 1'000; i++) {
+        auto n = BigInt::Below(10, rng);
+        QVERIFY(n < 10);
+        seen[std::stoul(n.str())]++;
+    }
+
+    for (auto s : seen) QVERIFY(s > 50);
+
+    // Including bounds that span several limbs.
+    auto bound = Pow2(70) + 5;
+    int high = 0;
+    for (int i = 0; i < 1'000; i++) {
+        auto n = BigInt::Below(bound, rng);
+        QVERIFY(n < bound);
+        if (n >= Pow2(69)) high++;
+    }
+
+    QVERIFY(high > 400 and high < 600);
+}
+
+QTEST_GUILESS_MAIN(BigIntTest)
+#include "BigIntTest.moc"
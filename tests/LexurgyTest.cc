@@ -0,0 +1,146 @@
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <UI/Lexurgy.hh>
+
+using namespace smyth;
+
+class LexurgyTest : public QObject {
+    Q_OBJECT
+
+    /// Why Lexurgy can’t be used, if it can’t.
+    std::optional<std::string> lexurgy_error;
+
+    /// Apply sound changes and wait for the result.
+    static auto Apply(QStringView words, const QString& changes) -> Result<QString> {
+        std::optional<Result<QString>> out;
+        auto id = Try(lexurgy::Apply(words, changes, {}, {}, [&](Result<QString> r) { out = std::move(r); }));
+        if (not QTest::qWaitFor([&] { return out.has_value(); }, 120'000)) {
+            lexurgy::Cancel(id);
+            return Error("Timed out waiting for Lexurgy");
+        }
+
+        return std::move(*out);
+    }
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void saves_and_loads_cache();
+    void uses_cached_results();
+    void native_engine_matches_lexurgy_data();
+    void native_engine_matches_lexurgy();
+};
+
+void LexurgyTest::initTestCase() {
+    lexurgy::SetServerCount(1);
+    lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Disabled);
+    auto res = Apply(u"a", "rule:\n    a => b");
+    if (not res) lexurgy_error = std::move(res).error();
+    else if (*res != "b\n") lexurgy_error = "Unexpected response from Lexurgy";
+}
+
+void LexurgyTest::cleanupTestCase() {
+    lexurgy::Close();
+}
+
+void LexurgyTest::saves_and_loads_cache() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto path = dir.filePath("cache.json");
+    auto changes = "rule:\n    a => e";
+
+    // Fill the cache using the native engine so we don’t need Lexurgy.
+    lexurgy::ClearCache();
+    lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Enabled);
+    QCOMPARE(Apply(u"pa\nta", changes).value(), QString{"pe\nte\n"});
+    QVERIFY(lexurgy::SaveCache(path).has_value());
+    lexurgy::ClearCache();
+
+    // Loading a file that doesn’t exist does nothing.
+    QVERIFY(lexurgy::LoadCache(dir.filePath("missing.json")).has_value());
+
+    // With the native engine disabled, this can only come from the cache
+    // (or Lexurgy, but we don’t want to depend on that here, so we check
+    // that it’s in the cache file as well).
+    QVERIFY(lexurgy::LoadCache(path).has_value());
+    lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Disabled);
+    QCOMPARE(Apply(u"ta\npa\nta", changes).value(), QString{"te\npe\nte\n"});
+
+    QFile f{path};
+    QVERIFY(f.open(QIODevice::ReadOnly));
+    auto saved = f.readAll();
+    QVERIFY(saved.contains(R"("pa":"pe")"));
+    QVERIFY(saved.contains(R"("ta":"te")"));
+}
+
+void LexurgyTest::uses_cached_results() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto path = dir.filePath("cache.json");
+    auto changes = "rule:\n    a => e";
+
+    // Results that are obviously not what the sound changes produce, so
+    // we know they came from the cache.
+    QFile f{path};
+    QVERIFY(f.open(QIODevice::WriteOnly));
+    f.write(R"({"changes": "rule:\n    a => e", "tables": [{"start": "", "stop": "", "words": {"pa": "cached"}}]})");
+    f.close();
+
+    lexurgy::ClearCache();
+    QVERIFY(lexurgy::LoadCache(path).has_value());
+    lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Enabled);
+
+    // Only words that aren’t cached are computed.
+    QCOMPARE(Apply(u"pa\nki\npa", changes).value(), QString{"cached\nki\ncached\n"});
+
+    // Different sound changes don’t use the cache.
+    QCOMPARE(Apply(u"pa", "rule:\n    a => o").value(), QString{"po\n"});
+
+    // Invalid files are rejected.
+    QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    f.write(R"({"tables": []})");
+    f.close();
+    QVERIFY(not lexurgy::LoadCache(path).has_value());
+
+    lexurgy::ClearCache();
+    lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Disabled);
+}
+
+void LexurgyTest::native_engine_matches_lexurgy_data() {
+    QTest::addColumn<QString>("changes");
+    QTest::addColumn<QString>("words");
+
+    auto words = QStringList{
+        "a", "pa", "apa", "appa", "tatta", "kiku", "ŋaŋ", "thatha",
+        "aiu", "uia", "pik", "hah", "mampa", "ntaka", "aaaa", "ptk",
+    }.join('\n');
+
+    QTest::newRow("substitution") << "rule:\n    a => e" << words;
+    QTest::newRow("sequence") << "first:\n    a => e\nsecond:\n    e => i\n    i => a" << words;
+    QTest::newRow("digraphs") << "rule:\n    th => s\n    t => d\n    h => *" << words;
+    QTest::newRow("environment") << "Class vowel {a, i, u}\nrule:\n    {p, t, k} => {b, d, g} / @vowel _ @vowel" << words;
+    QTest::newRow("simultaneous") << "rule:\n    a => i\n    i => u\n    u => a" << words;
+    QTest::newRow("boundaries") << "final:\n    a => e / _ $\ninitial:\n    a => o / $ _" << words;
+    QTest::newRow("deletion") << "rule:\n    {h, k} => * / _ $" << words;
+    QTest::newRow("assimilation") << "Class nasal {m, n, ŋ}\nrule:\n    @nasal => m / _ p\n    @nasal => n / _ t\n    @nasal => ŋ / _ k" << words;
+    QTest::newRow("geminates") << "rule:\n    pp => p\n    tt => t / a _ a" << words;
+    QTest::newRow("overlap") << "rule:\n    aa => b" << words;
+}
+
+void LexurgyTest::native_engine_matches_lexurgy() {
+    if (lexurgy_error) QSKIP(("Lexurgy is not available: " + *lexurgy_error).c_str());
+    QFETCH(QString, changes);
+    QFETCH(QString, words);
+
+    // In differential mode, a mismatch between the two engines is an error.
+    lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Differential);
+    auto res = Apply(words, changes);
+    lexurgy::SetNativeEngineMode(lexurgy::NativeEngineMode::Disabled);
+    auto fallback = lexurgy::NativeEngineFallbackReason();
+    QVERIFY2(not fallback, fallback.value_or("").c_str());
+    QVERIFY2(res.has_value(), res.error().c_str());
+}
+
+QTEST_GUILESS_MAIN(LexurgyTest)
+#include "LexurgyTest.moc"
@@ -0,0 +1,158 @@
+#include <QTest>
+#include <Smyth/NativeEngine.hh>
+
+using namespace smyth;
+using namespace smyth::sca;
+
+class NativeEngineTest : public QObject {
+    Q_OBJECT
+
+    /// Compile sound changes and apply them to some words.
+    static auto Apply(
+        QStringView changes,
+        const QStringList& words,
+        QStringView start_at = {},
+        QStringView stop_before = {}
+    ) -> Result<QString> {
+        auto e = Try(Engine::Compile(changes));
+        std::vector<QStringView> views(words.begin(), words.end());
+        return e.apply(views, start_at, stop_before);
+    }
+
+    /// Check the result of applying sound changes.
+    static void Check(QStringView changes, const QStringList& words, const QStringList& expected) {
+        auto res = Apply(changes, words);
+        QVERIFY2(res.has_value(), res.error().c_str());
+        QCOMPARE(*res, expected.join('\n') + '\n');
+    }
+
+private slots:
+    void rejects_unsupported_changes_data();
+    void rejects_unsupported_changes();
+    void applies_rules_in_order();
+    void applies_expressions_simultaneously();
+    void matches_environments();
+    void matches_word_boundaries();
+    void maps_sets();
+    void deletes_matches();
+    void starts_and_stops_at_rules();
+    void rejects_unsupported_words();
+    void splits_large_inputs();
+};
+
+void NativeEngineTest::rejects_unsupported_changes_data() {
+    QTest::addColumn<QString>("changes");
+    QTest::newRow("features") << "Feature voicing (voiced)\nrule:\n    a => b";
+    QTest::newRow("syllables") << "Syllables:\n    @vowel";
+    QTest::newRow("romanizer") << "romanizer:\n    a => b";
+    QTest::newRow("deromanizer") << "Deromanizer:\n    a => b";
+    QTest::newRow("then") << "rule:\n    a => b\n    Then:\n    b => c";
+    QTest::newRow("exceptions") << "rule:\n    a => b / _ c // d _";
+    QTest::newRow("insertion") << "rule:\n    * => a / b _";
+    QTest::newRow("missing rhs") << "rule:\n    a => ";
+    QTest::newRow("two arrows") << "rule:\n    a => b => c";
+    QTest::newRow("two underscores") << "rule:\n    a => b / _ _";
+    QTest::newRow("boundary inside") << "rule:\n    a => b / c $ _";
+    QTest::newRow("unknown class") << "rule:\n    @vowel => a";
+    QTest::newRow("unterminated set") << "rule:\n    {a, b => c";
+    QTest::newRow("set mismatch") << "rule:\n    {a, b} => {c, d, e}";
+    QTest::newRow("set from literal") << "rule:\n    a => {c, d}";
+    QTest::newRow("empty rule") << "rule:\nother:\n    a => b";
+    QTest::newRow("duplicate rule") << "rule:\n    a => b\nrule:\n    b => c";
+    QTest::newRow("duplicate class") << "Class c {a}\nClass c {b}";
+    QTest::newRow("no rule") << "a => b";
+    QTest::newRow("punctuation") << "rule:\n    a. => b";
+    QTest::newRow("combining mark") << "rule:\n    a\u0301 => b";
+    QTest::newRow("modifier") << "rule rtl:\n    a => b";
+}
+
+void NativeEngineTest::rejects_unsupported_changes() {
+    QFETCH(QString, changes);
+    QVERIFY(not Engine::Compile(changes).has_value());
+}
+
+void NativeEngineTest::applies_rules_in_order() {
+    Check(u"first:\n    a => b\nsecond:\n    b => c", {"ab", "ba", "x"}, {"cc", "cc", "x"});
+    Check(u"# comment\nfirst: a => b # trailing\n", {"aa"}, {"bb"});
+    Check(u"long-rule-name:\n    th => s\n    t => d", {"tht", "th"}, {"sd", "s"});
+}
+
+void NativeEngineTest::applies_expressions_simultaneously() {
+    Check(u"swap:\n    a => b\n    b => a", {"abba", "ab"}, {"baab", "ba"});
+
+    // The first expression that matches wins.
+    Check(u"rule:\n    a => b / _ c\n    a => d", {"ac", "ab"}, {"bc", "db"});
+}
+
+void NativeEngineTest::matches_environments() {
+    Check(
+        u"Class vowel {a, e, i}\nrule:\n    p => b / @vowel _ @vowel",
+        {"apa", "pa", "ap", "epi", "appa"},
+        {"aba", "pa", "ap", "ebi", "appa"}
+    );
+
+    // Environments see the word as it was before the rule.
+    Check(u"rule:\n    a => b / a _", {"aaa", "baa"}, {"abb", "bab"});
+    Check(u"rule:\n    a => b / _ {c, d}", {"acad", "aa"}, {"bcbd", "aa"});
+}
+
+void NativeEngineTest::matches_word_boundaries() {
+    Check(u"rule:\n    a => e / _ $", {"aba", "a", "ab"}, {"abe", "e", "ab"});
+    Check(u"rule:\n    a => o / $ _", {"aba", "ba"}, {"oba", "ba"});
+    Check(u"rule:\n    a => i / $ _ $", {"a", "aa"}, {"i", "aa"});
+}
+
+void NativeEngineTest::maps_sets() {
+    Check(u"rule:\n    {p, t, k} => {b, d, g}", {"pataka"}, {"badaga"});
+    Check(
+        u"Class voiceless {p, t}\nClass voiced {b, d}\nrule:\n    @voiceless => @voiced / _ a",
+        {"pato", "tapa"},
+        {"bato", "daba"}
+    );
+
+    // Sets can contain classes.
+    Check(u"Class nasal {m, n}\nrule:\n    {@nasal, ŋ} => {n, n, n}", {"maŋ"}, {"nan"});
+}
+
+void NativeEngineTest::deletes_matches() {
+    Check(u"rule:\n    h => * / _ $", {"hah", "h"}, {"ha", ""});
+    Check(u"rule:\n    {a, e} => *", {"tae"}, {"t"});
+}
+
+void NativeEngineTest::starts_and_stops_at_rules() {
+    auto changes = u"first:\n    a => b\nsecond:\n    b => c\nthird:\n    c => d";
+    QCOMPARE(Apply(changes, {"a"}, u"second").value(), QString{"a\n"});
+    QCOMPARE(Apply(changes, {"b"}, u"second").value(), QString{"d\n"});
+    QCOMPARE(Apply(changes, {"a"}, {}, u"second").value(), QString{"b\n"});
+    QCOMPARE(Apply(changes, {"a"}, {}, u"third").value(), QString{"c\n"});
+    QCOMPARE(Apply(changes, {"b"}, u"second", u"third").value(), QString{"c\n"});
+    QVERIFY(not Apply(changes, {"a"}, u"fourth").has_value());
+    QVERIFY(not Apply(changes, {"a"}, u"third", u"first").has_value());
+}
+
+void NativeEngineTest::rejects_unsupported_words() {
+    QVERIFY(not Apply(u"rule:\n    a => b", {"a-b"}).has_value());
+    QVERIFY(not Apply(u"rule:\n    a => b", {"a b"}).has_value());
+    QVERIFY(not Apply(u"rule:\n    a => b", {"a\u0301"}).has_value());
+    QVERIFY(not Apply(u"rule:\n    a => b", {"\u00e1"}).has_value());
+    QVERIFY(Apply(u"rule:\n    a => b", {"ŋ😀"}).has_value());
+}
+
+void NativeEngineTest::splits_large_inputs() {
+    // Enough words to be processed on several threads; the result must be
+    // the same as if they were processed one by one, in order.
+    auto changes = u"Class vowel {a, i, u}\nrule:\n    {p, t, k} => {b, d, g} / @vowel _ @vowel\nfinal:\n    @vowel => * / _ $";
+    QStringList words, expected;
+    for (int i = 0; i < 50'000; i++) {
+        QString w;
+        for (int n = i; n != 0; n /= 6) w += "ptkaiu"[n % 6];
+        if (w.isEmpty()) w = "a";
+        words.push_back(w);
+        expected.push_back(Apply(changes, {w}).value().chopped(1));
+    }
+
+    Check(changes, words, expected);
+}
+
+QTEST_GUILESS_MAIN(NativeEngineTest)
+#include "NativeEngineTest.moc"
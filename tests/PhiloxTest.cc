@@ -0,0 +1,77 @@
+#include <QTest>
+#include <Smyth/Philox.hh>
+
+using namespace smyth;
+
+class PhiloxTest : public QObject {
+    Q_OBJECT
+
+    using Block = std::array<u32, 4>;
+    using Key = std::array<u32, 2>;
+
+private slots:
+    void matches_known_answers();
+    void generates_blocks_in_order();
+    void separates_streams();
+};
+
+// Known-answer tests for Philox4x32-10 from the Random123 distribution.
+void PhiloxTest::matches_known_answers() {
+    struct KAT {
+        Block ctr;
+        Key key;
+        Block expected;
+    };
+
+    static constexpr KAT Tests[]{
+        {
+            {0, 0, 0, 0},
+            {0, 0},
+            {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+        },
+        {
+            {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+            {0xffffffff, 0xffffffff},
+            {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+        },
+        {
+            {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+            {0xa4093822, 0x299f31d0},
+            {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1},
+        },
+    };
+
+    for (const auto& t : Tests) QVERIFY(Philox::Block(t.ctr, t.key) == t.expected);
+
+    // This is constexpr, so check at compile time too.
+    static_assert(Philox::Block(Tests[0].ctr, Tests[0].key) == Tests[0].expected);
+}
+
+void PhiloxTest::generates_blocks_in_order() {
+    constexpr u64 seed = 0x0123'4567'89ab'cdef;
+    constexpr u64 stream = 0xfedc'ba98'7654'3210;
+    Philox rng{seed, stream, 42};
+    Key key{u32(seed), u32(seed >> 32)};
+    for (u32 i = 0; i < 3; i++) {
+        auto block = Philox::Block({i, 42, u32(stream), u32(stream >> 32)}, key);
+        for (auto n : block) QCOMPARE(rng(), n);
+    }
+}
+
+void PhiloxTest::separates_streams() {
+    auto First = [](Philox rng) {
+        std::array<u32, 8> out;
+        for (auto& n : out) n = rng();
+        return out;
+    };
+
+    auto base = First(Philox{1, 0, 0});
+    QVERIFY(base == First(Philox{1, 0, 0}));
+    QVERIFY(base != First(Philox{2, 0, 0}));
+    QVERIFY(base != First(Philox{1, 1, 0}));
+    QVERIFY(base != First(Philox{1, u64(1) << 32, 0}));
+    QVERIFY(base != First(Philox{1, 0, 1}));
+}
+
+QTEST_GUILESS_MAIN(PhiloxTest)
+#include "PhiloxTest.moc"
@@ -0,0 +1,165 @@
+#include <QTest>
+#include <UI/LexurgyProtocol.hh>
+
+using namespace smyth;
+using namespace smyth::lexurgy::detail;
+
+class ProtocolTest : public QObject {
+    Q_OBJECT
+
+    /// Feed data to a reader and get the only response it produces.
+    static auto ReadOne(ResponseReader& r, QByteArrayView data) -> Result<ResponseReader::Response> {
+        r.feed(data);
+        auto res = r.take();
+        if (not res) return Error("No response");
+        if (r.take()) return Error("More than one response");
+        return std::move(*res);
+    }
+
+private slots:
+    void reads_words_and_header();
+    void reads_data_in_pieces();
+    void reads_several_responses();
+    void decodes_escapes();
+    void ignores_blank_lines();
+    void reports_invalid_escapes();
+    void reports_malformed_responses();
+    void reset_discards_partial_response();
+    void apply_request_round_trip();
+    void load_request_round_trip();
+};
+
+void ProtocolTest::reads_words_and_header() {
+    ResponseReader r;
+    auto res = ReadOne(r, R"({"type": "changed", "words": ["a", "bc", ""], "extra": {"x": [1, 2]}})" "\n");
+    QVERIFY(res.has_value());
+    QVERIFY(res->header["type"] == "changed");
+    QVERIFY(res->header["extra"]["x"][1] == 2);
+    QVERIFY(res->header["words"].empty());
+    QCOMPARE(res->words, QString{"a\nbc\n\n"});
+}
+
+void ProtocolTest::reads_data_in_pieces() {
+    // Split everywhere, including in the middle of UTF-8 sequences
+    // and escape sequences.
+    QByteArray data = R"({"type":"changed","words":["éé","😀x","a\"b"]})" "\n";
+    ResponseReader r;
+    for (auto c : data) r.feed(QByteArrayView{&c, 1});
+    auto res = r.take();
+    QVERIFY(res.has_value());
+    QVERIFY(res->has_value());
+    QVERIFY((*res)->header["type"] == "changed");
+    QCOMPARE((*res)->words, QString{"éé\n😀x\na\"b\n"});
+    QVERIFY(not r.take());
+}
+
+void ProtocolTest::reads_several_responses() {
+    ResponseReader r;
+    r.feed(R"({"type":"changed","words":["a"]})" "\n" R"({"type":"ok"})" "\n" R"({"type":"changed","words":["b"]})");
+    auto first = r.take();
+    auto second = r.take();
+    QVERIFY(first and first->has_value());
+    QVERIFY(second and second->has_value());
+    QCOMPARE((*first)->words, QString{"a\n"});
+    QVERIFY((*second)->header["type"] == "ok");
+    QVERIFY((*second)->words.isEmpty());
+
+    // The last one isn’t complete until we see the newline.
+    QVERIFY(not r.take());
+    r.feed("\n");
+    auto third = r.take();
+    QVERIFY(third and third->has_value());
+    QCOMPARE((*third)->words, QString{"b\n"});
+}
+
+void ProtocolTest::decodes_escapes() {
+    ResponseReader r;
+    auto res = ReadOne(r, R"({"words":["\"\\\/\b\f\n\r\t","\u0041ß","\ud800"]})" "\n");
+    QVERIFY(res.has_value());
+    QString expected{"\"\\/\b\f\n\r\t\nAß\n"};
+    expected += QChar(0xD800);
+    expected += '\n';
+    QCOMPARE(res->words, expected);
+}
+
+void ProtocolTest::ignores_blank_lines() {
+    ResponseReader r;
+    r.feed("\n\n  \n");
+    QVERIFY(not r.take());
+    auto res = ReadOne(r, "\n" R"({"type":"ok"})" "\n\n");
+    QVERIFY(res.has_value());
+}
+
+void ProtocolTest::reports_invalid_escapes() {
+    ResponseReader r;
+    r.feed(R"({"words":["\x"],"type":"changed"})" "\n" R"({"words":["\u12"]})" "\n");
+    for (int i = 0; i < 2; i++) {
+        auto res = r.take();
+        QVERIFY(res.has_value());
+        QVERIFY(not res->has_value());
+    }
+
+    // The rest of a bad response is dropped, but the next one is fine.
+    auto res = ReadOne(r, R"({"words":["ok"]})" "\n");
+    QVERIFY(res.has_value());
+    QCOMPARE(res->words, QString{"ok\n"});
+}
+
+void ProtocolTest::reports_malformed_responses() {
+    ResponseReader r;
+    r.feed(R"({"words":["a"])" "\n" R"({"type":)" "\n");
+    for (int i = 0; i < 2; i++) {
+        auto res = r.take();
+        QVERIFY(res.has_value());
+        QVERIFY(not res->has_value());
+    }
+
+    QVERIFY(not r.take());
+}
+
+void ProtocolTest::reset_discards_partial_response() {
+    ResponseReader r;
+    r.feed(R"({"type":"changed","words":["abc","de)");
+    r.reset();
+    auto res = ReadOne(r, R"({"type":"changed","words":["x"]})" "\n");
+    QVERIFY(res.has_value());
+    QCOMPARE(res->words, QString{"x\n"});
+}
+
+void ProtocolTest::apply_request_round_trip() {
+    QString unpaired = "a";
+    unpaired += QChar(0xDC00);
+    std::vector<QString> words{"plain", "quote\"back\\slash", "tab\tcr\rctl\x01", "ŋʷʰ", "😀", unpaired, ""};
+    std::vector<QStringView> views{words.begin(), words.end()};
+
+    // The request must be valid JSON.
+    auto req = EncodeApply(views, u"start", u"stop");
+    auto j = json_utils::Parse(req);
+    QVERIFY(j.has_value());
+    QVERIFY((*j)["type"] == "apply");
+    QVERIFY((*j)["startAt"] == "start");
+    QVERIFY((*j)["stopBefore"] == "stop");
+    QCOMPARE((*j)["words"].size(), words.size());
+    QVERIFY(not EncodeApply(views).contains("startAt"));
+
+    // And reading it back must get us the same words, except that the
+    // unpaired surrogate is replaced.
+    QString expected;
+    for (const auto& w : words) expected += w + '\n';
+    expected.replace(QChar(0xDC00), QChar::ReplacementCharacter);
+    ResponseReader r;
+    auto res = ReadOne(r, QByteArray::fromStdString(req + "\n"));
+    QVERIFY(res.has_value());
+    QCOMPARE(res->words, expected);
+}
+
+void ProtocolTest::load_request_round_trip() {
+    QString changes = "Class vowel {a, e}\n\nrule:\n    @vowel => * / _ \"$\"\n";
+    auto j = json_utils::Parse(EncodeLoadChanges(changes));
+    QVERIFY(j.has_value());
+    QVERIFY((*j)["type"] == "load_string");
+    QCOMPARE(QString::fromStdString((*j)["changes"].get<std::string>()), changes);
+}
+
+QTEST_GUILESS_MAIN(ProtocolTest)
+#include "ProtocolTest.moc"
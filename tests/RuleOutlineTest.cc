@@ -0,0 +1,174 @@
+#include <QRandomGenerator>
+#include <QSignalSpy>
+#include <QTest>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <UI/RuleOutline.hh>
+
+using namespace smyth;
+using namespace smyth::ui;
+
+class RuleOutlineTest : public QObject {
+    Q_OBJECT
+
+    /// Replace a line in a document.
+    static void ReplaceLine(QTextDocument& doc, int line, const QString& text) {
+        QTextCursor c{doc.findBlockByNumber(line)};
+        c.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        c.insertText(text);
+    }
+
+    /// Parse a line, returning a placeholder if it doesn’t start a rule.
+    static auto Name(QStringView line) -> QString {
+        auto name = RuleOutline::ParseRuleName(line);
+        return name ? name->toString() : "<none>";
+    }
+
+private slots:
+    void parses_rule_names();
+    void parses_documents();
+    void tracks_rule_positions();
+    void updates_names_on_edit();
+    void matches_full_reparse_after_edits();
+};
+
+void RuleOutlineTest::parses_rule_names() {
+    QCOMPARE(Name(u"rule:"), QString{"rule"});
+    QCOMPARE(Name(u"  rule:  a => b"), QString{"<none>"});
+    QCOMPARE(Name(u"  rule:  "), QString{"rule"});
+    QCOMPARE(Name(u"rule ltr:"), QString{"rule"});
+    QCOMPARE(Name(u"# rule:"), QString{"<none>"});
+    QCOMPARE(Name(u"\\rule:"), QString{"<none>"});
+    QCOMPARE(Name(u"a => b"), QString{"<none>"});
+    QCOMPARE(Name(u"Class vowel {a, e}"), QString{"<none>"});
+    QCOMPARE(Name(u""), QString{"<none>"});
+}
+
+void RuleOutlineTest::parses_documents() {
+    auto text = u"Class vowel {a, e}\n"
+                u"first:\n"
+                u"    a => e\n"
+                u"romanizer:\n"
+                u"    e => a\n"
+                u"# not-a-rule:\n"
+                u"second propagate:\n"
+                u"    e => i\n"
+                u"Then:\n"
+                u"    i => a";
+
+    QCOMPARE(RuleOutline::Parse(text), (QStringList{"first", "second"}));
+
+    QTextDocument doc{QString::fromUtf16(text)};
+    RuleOutline o{&doc};
+    QCOMPARE(o.names(), (QStringList{"first", "second"}));
+    QCOMPARE(o.rules().size(), usz(4));
+    QVERIFY(o.rules()[1].special);
+    QVERIFY(o.rules()[3].special);
+    QVERIFY(o.find(u"romanizer"));
+    QVERIFY(not o.find(u"vowel"));
+}
+
+void RuleOutlineTest::tracks_rule_positions() {
+    QTextDocument doc{"first:\n    a => b\nsecond:\n    b => c"};
+    RuleOutline o{&doc};
+    auto r = o.rules();
+    QCOMPARE(r.size(), usz(2));
+    QCOMPARE(r[0].name, QString{"first"});
+    QCOMPARE(r[0].line, 0);
+    QCOMPARE(r[0].begin, 0);
+    QCOMPARE(r[0].end, 18);
+    QCOMPARE(r[1].name, QString{"second"});
+    QCOMPARE(r[1].line, 2);
+    QCOMPARE(r[1].begin, 18);
+    QCOMPARE(r[1].end, doc.characterCount());
+
+    // Edits that don’t touch a rule header still move the rules after them.
+    QTextCursor c{&doc};
+    c.insertText("Class x {a}\n");
+    auto second = o.find(u"second");
+    QVERIFY(second);
+    QCOMPARE(second->line, 3);
+    QCOMPARE(second->begin, 30);
+}
+
+void RuleOutlineTest::updates_names_on_edit() {
+    QTextDocument doc{"first:\n    a => b\nsecond:\n    b => c"};
+    RuleOutline o{&doc};
+    QSignalSpy spy{&o, &RuleOutline::namesChanged};
+
+    // Editing a rule’s body doesn’t change anything.
+    ReplaceLine(doc, 1, "    a => c");
+    QCOMPARE(spy.count(), 0);
+
+    // Nor does editing its header without changing its name.
+    ReplaceLine(doc, 0, "first ltr:");
+    QCOMPARE(spy.count(), 0);
+
+    // Adding a rule.
+    QTextCursor c{doc.findBlockByNumber(1)};
+    c.movePosition(QTextCursor::EndOfBlock);
+    c.insertText("\nmiddle:\n    x => y");
+    QCOMPARE(o.names(), (QStringList{"first", "middle", "second"}));
+    QCOMPARE(spy.count(), 1);
+
+    // Renaming a rule.
+    ReplaceLine(doc, 4, "last:");
+    QCOMPARE(o.names(), (QStringList{"first", "middle", "last"}));
+    QCOMPARE(spy.count(), 2);
+
+    // Turning a rule header into something else.
+    ReplaceLine(doc, 2, "    middle => x");
+    QCOMPARE(o.names(), (QStringList{"first", "last"}));
+    QCOMPARE(spy.count(), 3);
+
+    // Deleting a rule along with its header.
+    c = QTextCursor{doc.findBlockByNumber(0)};
+    c.setPosition(doc.findBlockByNumber(2).position(), QTextCursor::KeepAnchor);
+    c.removeSelectedText();
+    QCOMPARE(o.names(), QStringList{"last"});
+    QCOMPARE(spy.count(), 4);
+
+    // Replacing everything.
+    doc.setPlainText("a:\nb:\n");
+    QCOMPARE(o.names(), (QStringList{"a", "b"}));
+    QVERIFY(spy.count() > 4);
+}
+
+void RuleOutlineTest::matches_full_reparse_after_edits() {
+    // Apply lots of random edits and check that we always end up with the
+    // same rules as parsing the entire document from scratch.
+    static const QStringList Snippets{
+        "rule:",
+        "\n",
+        "\nnew-rule:\n",
+        "    a => b\n",
+        "romanizer:\n",
+        ":",
+        " ",
+        "x",
+        "# ",
+        "=>",
+        "\\",
+    };
+
+    QTextDocument doc{"first:\n    a => b\nsecond:\n    b => c\n"};
+    RuleOutline o{&doc};
+    QRandomGenerator rng{42};
+    for (int i = 0; i < 2'000; i++) {
+        QTextCursor c{&doc};
+        c.setPosition(rng.bounded(doc.characterCount()));
+        if (rng.bounded(3) == 0) {
+            auto end = std::min(c.position() + rng.bounded(20), doc.characterCount() - 1);
+            c.setPosition(end, QTextCursor::KeepAnchor);
+            c.removeSelectedText();
+        } else {
+            c.insertText(Snippets[rng.bounded(int(Snippets.size()))]);
+        }
+
+        auto expected = RuleOutline::Parse(doc.toPlainText());
+        QCOMPARE(o.names(), expected);
+    }
+}
+
+QTEST_MAIN(RuleOutlineTest)
+#include "RuleOutlineTest.moc"
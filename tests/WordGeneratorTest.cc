@@ -0,0 +1,284 @@
+#include <QRegularExpression>
+#include <QTest>
+#include <Smyth/WordGenerator.hh>
+#include <Smyth/WordIndex.hh>
+#include <cmath>
+
+using namespace smyth;
+using namespace smyth::wordgen;
+
+class WordGeneratorTest : public QObject {
+    Q_OBJECT
+
+    /// Split generated words into lines.
+    static auto Lines(const QString& text) -> QStringList {
+        auto lines = text.split('\n');
+        if (not lines.empty() and lines.back().isEmpty()) lines.pop_back();
+        return lines;
+    }
+
+    /// Generate words and check that they all match a regex.
+    static void CheckWords(QStringView classes, QStringView pattern, const QString& regex) {
+        auto g = Generator::Compile(classes, pattern);
+        QVERIFY2(g.has_value(), g.error().c_str());
+        auto words = g->generate(1'000, 42);
+        QVERIFY2(words.has_value(), words.error().c_str());
+        auto lines = Lines(words->text);
+        QCOMPARE(lines.size(), qsizetype(1'000));
+        QRegularExpression re{QRegularExpression::anchoredPattern(regex)};
+        for (const auto& w : lines) QVERIFY2(re.match(w).hasMatch(), qPrintable(w));
+    }
+
+private slots:
+    void generates_words_matching_pattern();
+    void rejects_invalid_input_data();
+    void rejects_invalid_input();
+    void rejects_patterns_with_empty_words();
+    void applies_filters();
+    void generates_words_deterministically();
+    void picks_weighted_members();
+    void picks_weighted_members_from_large_classes();
+    void picks_weighted_alternatives();
+    void rejects_invalid_weights_data();
+    void rejects_invalid_weights();
+    void counts_words();
+    void counts_distinct_words();
+    void unranks_words_in_order();
+    void samples_words_uniformly();
+    void excludes_words();
+};
+
+void WordGeneratorTest::generates_words_matching_pattern() {
+    CheckWords(u"C = p, t, k\nV = a, i", u"CV(C)", "[ptk][ai][ptk]?");
+    CheckWords(u"C = p, t, k\nV = a, i", u"s C V", "s[ptk][ai]");
+    CheckWords(u"C = p, th\nV = a, ei", u"[CV|V]C", "(p|th)?(a|ei)(p|th)");
+    CheckWords(u"C = p\nV = a", u"C(V(C))", "p(ap?)?");
+}
+
+void WordGeneratorTest::rejects_invalid_input_data() {
+    QTest::addColumn<QString>("classes");
+    QTest::addColumn<QString>("pattern");
+    QTest::newRow("empty pattern") << "C = p" << "  ";
+    QTest::newRow("unclosed optional") << "C = p" << "C(C";
+    QTest::newRow("unclosed choice") << "C = p" << "[C|C";
+    QTest::newRow("stray paren") << "C = p" << "C)";
+    QTest::newRow("long class name") << "CC = p" << "C";
+    QTest::newRow("missing equals") << "C p, t" << "C";
+    QTest::newRow("duplicate class") << "C = p\nC = t" << "C";
+    QTest::newRow("empty member") << "C = p,,t" << "C";
+}
+
+void WordGeneratorTest::rejects_invalid_input() {
+    QFETCH(QString, classes);
+    QFETCH(QString, pattern);
+    QVERIFY(not Generator::Compile(classes, pattern).has_value());
+}
+
+void WordGeneratorTest::rejects_patterns_with_empty_words() {
+    // These can all generate the empty word, which would show up as an
+    // empty line and would also be counted as a word.
+    for (auto pattern : {u"(C)", u"(C)(V)", u"[C|]", u"[C|(V)]", u"[(C)|V]"}) {
+        auto g = Generator::Compile(u"C = p\nV = a", pattern);
+        QVERIFY2(not g.has_value(), qPrintable(QString::fromUtf16(pattern)));
+    }
+
+    // But these can’t.
+    for (auto pattern : {u"(C)V", u"[C|V]", u"[C|(V)V]", u"([C|V])C"}) {
+        auto g = Generator::Compile(u"C = p\nV = a", pattern);
+        QVERIFY2(g.has_value(), qPrintable(QString::fromUtf16(pattern)));
+    }
+}
+
+void WordGeneratorTest::applies_filters() {
+    auto g = Generator::Compile(u"C = p, t\nV = a\nreject: pt, aa", u"CV(C)(V)");
+    QVERIFY(g.has_value());
+    QVERIFY(g->has_filters());
+    auto words = g->generate(2'000, 7);
+    QVERIFY(words.has_value());
+    QVERIFY(words->rejected != 0);
+    for (const auto& w : Lines(words->text)) {
+        QVERIFY2(not w.contains(u"pt"), qPrintable(w));
+        QVERIFY2(not w.contains(u"aa"), qPrintable(w));
+    }
+}
+
+void WordGeneratorTest::generates_words_deterministically() {
+    auto g = Generator::Compile(u"C = p, t, k:3\nV = a, i", u"CV(C)");
+    QVERIFY(g.has_value());
+    auto a = g->generate(1'000, 9);
+    auto b = g->generate(1'000, 9);
+    auto c = g->generate(1'000, 10);
+    QVERIFY(a.has_value() and b.has_value() and c.has_value());
+    QCOMPARE(a->text, b->text);
+    QVERIFY(a->text != c->text);
+
+    // Every word has its own stream, so generating more words, which
+    // happens on several threads, doesn’t change the first ones.
+    auto many = g->generate(100'000, 9);
+    QVERIFY(many.has_value());
+    QVERIFY(many->text.startsWith(a->text));
+}
+
+void WordGeneratorTest::picks_weighted_members() {
+    auto g = Generator::Compile(u"C = a:3, b, c:0.5, d:1.5", u"C");
+    QVERIFY(g.has_value());
+    auto words = g->generate(200'000, 1);
+    QVERIFY(words.has_value());
+    auto freqs = g->frequencies(words->draws);
+    QCOMPARE(freqs.size(), usz(4));
+    QCOMPARE(freqs[0].member, QString{"a"});
+    QCOMPARE(freqs[0].expected, 0.5);
+    for (const auto& f : freqs) {
+        QCOMPARE(f.cls, QChar('C'));
+        QVERIFY2(std::abs(f.actual - f.expected) < 0.01, qPrintable(f.member));
+    }
+}
+
+void WordGeneratorTest::picks_weighted_members_from_large_classes() {
+    // Enough members that a bad alias table would be noticeable.
+    QStringList members;
+    for (int i = 0; i < 100; i++) members.push_back(QString{"m%1:%2"}.arg(i).arg(i % 7 + 1));
+    auto g = Generator::Compile(QString{"C = "} + members.join(", "), u"C");
+    QVERIFY(g.has_value());
+    auto words = g->generate(1'000'000, 2);
+    QVERIFY(words.has_value());
+    auto freqs = g->frequencies(words->draws);
+    QCOMPARE(freqs.size(), usz(100));
+    for (const auto& f : freqs) QVERIFY2(
+        std::abs(f.actual - f.expected) < 0.1 * f.expected,
+        qPrintable(f.member)
+    );
+}
+
+void WordGeneratorTest::picks_weighted_alternatives() {
+    auto g = Generator::Compile(u"", u"[a:1|b:4]");
+    QVERIFY(g.has_value());
+    auto words = g->generate(100'000, 3);
+    QVERIFY(words.has_value());
+    auto lines = Lines(words->text);
+    QCOMPARE(lines.size(), qsizetype(100'000));
+    auto b = double(lines.count(QString{"b"})) / double(lines.size());
+    QVERIFY2(std::abs(b - 0.8) < 0.01, qPrintable(QString::number(b)));
+}
+
+void WordGeneratorTest::rejects_invalid_weights_data() {
+    QTest::addColumn<QString>("classes");
+    QTest::addColumn<QString>("pattern");
+    QTest::newRow("zero") << "C = a:0, b" << "C";
+    QTest::newRow("negative") << "C = a:-1, b" << "C";
+    QTest::newRow("not a number") << "C = a:x, b" << "C";
+    QTest::newRow("infinite") << "C = a:inf, b" << "C";
+    QTest::newRow("missing") << "C = a:, b" << "C";
+    QTest::newRow("zero alternative") << "C = a" << "[C:0|a]";
+    QTest::newRow("invalid alternative") << "C = a" << "[C|a:y]";
+}
+
+void WordGeneratorTest::rejects_invalid_weights() {
+    QFETCH(QString, classes);
+    QFETCH(QString, pattern);
+    QVERIFY(not Generator::Compile(classes, pattern).has_value());
+}
+
+void WordGeneratorTest::counts_words() {
+    auto g = Generator::Compile(u"C = p, t, k\nV = a, i", u"CV(C)");
+    QVERIFY(g.has_value());
+    auto space = g->space();
+    QVERIFY(space.has_value());
+    QCOMPARE(space->size(), BigInt{24});
+    auto counts = space->counts();
+    QCOMPARE(counts.size(), usz(4));
+    QVERIFY(counts[0].is_zero());
+    QVERIFY(counts[1].is_zero());
+    QCOMPARE(counts[2], BigInt{6});
+    QCOMPARE(counts[3], BigInt{18});
+    QCOMPARE(space->unrank(0), QString{"ka"});
+    QCOMPARE(space->unrank(23), QString{"tit"});
+}
+
+void WordGeneratorTest::counts_distinct_words() {
+    // ‘th’ can be generated in two different ways but is one word.
+    auto g = Generator::Compile(u"C = t, th, h", u"C(C)");
+    QVERIFY(g.has_value());
+    auto space = g->space();
+    QVERIFY(space.has_value());
+    QCOMPARE(space->size(), BigInt{11});
+
+    // Filters remove ‘hh’ and ‘thh’.
+    g = Generator::Compile(u"C = t, th, h\nreject: hh", u"C(C)");
+    QVERIFY(g.has_value());
+    auto filtered = g->space();
+    QVERIFY(filtered.has_value());
+    QCOMPARE(filtered->size(), BigInt{9});
+    auto unfiltered = g->space(false);
+    QVERIFY(unfiltered.has_value());
+    QCOMPARE(unfiltered->size(), BigInt{11});
+
+    // The number of words can easily exceed 64 bits.
+    g = Generator::Compile(u"C = a, b, c, d, e, f, g, h", u"CCCCCCCCCCCCCCCCCCCCCCC");
+    QVERIFY(g.has_value());
+    auto large = g->space();
+    QVERIFY(large.has_value());
+    QCOMPARE(large->size().str(), std::string{"590295810358705651712"});
+}
+
+void WordGeneratorTest::unranks_words_in_order() {
+    auto g = Generator::Compile(u"C = t, th, h, ŋ\nV = a, ei, o\nreject: hh", u"[C|V](C)V(C)");
+    QVERIFY(g.has_value());
+    auto space = g->space();
+    QVERIFY(space.has_value());
+
+    QStringList words;
+    for (BigInt i; i < space->size(); i += 1) words.push_back(space->unrank(i));
+    auto sorted = words;
+    std::ranges::sort(sorted, [](const QString& a, const QString& b) {
+        if (a.size() != b.size()) return a.size() < b.size();
+        return a < b;
+    });
+
+    QCOMPARE(words, sorted);
+    QCOMPARE(qsizetype(QSet<QString>{words.begin(), words.end()}.size()), words.size());
+    for (const auto& w : words) QVERIFY2(not w.contains(u"hh"), qPrintable(w));
+}
+
+void WordGeneratorTest::samples_words_uniformly() {
+    auto g = Generator::Compile(u"C = p:10, t, k\nV = a, i:5", u"CV(C)");
+    QVERIFY(g.has_value());
+    auto space = g->space();
+    QVERIFY(space.has_value());
+
+    // Weights don’t matter here: every distinct word is equally likely.
+    QHash<QString, int> counts;
+    auto words = space->sample(24'000, 5);
+    QVERIFY(words.has_value());
+    for (const auto& w : Lines(*words)) counts[w]++;
+    QCOMPARE(counts.size(), qsizetype(24));
+    for (auto [w, n] : counts.asKeyValueRange()) QVERIFY2(n > 800 and n < 1'200, qPrintable(w));
+
+    // The result only depends on the seed.
+    QCOMPARE(space->sample(100, 6), space->sample(100, 6));
+}
+
+void WordGeneratorTest::excludes_words() {
+    auto g = Generator::Compile(u"C = p, t, k\nV = a, i", u"CV(C)");
+    QVERIFY(g.has_value());
+    auto exclude = WordIndex::Build({"ka", "pa", "tit"});
+    QVERIFY(exclude.has_value());
+
+    auto space = g->space();
+    QVERIFY(space.has_value());
+    auto sampled = space->sample(15, 8, &*exclude);
+    QVERIFY(sampled.has_value());
+
+    auto generated = g->generate(15, 8, &*exclude);
+    QVERIFY(generated.has_value());
+
+    for (const auto& text : {*sampled, generated->text}) {
+        auto words = Lines(text);
+        QCOMPARE(words.size(), qsizetype(15));
+        QCOMPARE(qsizetype(QSet<QString>{words.begin(), words.end()}.size()), words.size());
+        for (const auto& w : words) QVERIFY2(not exclude->contains(w), qPrintable(w));
+    }
+}
+
+QTEST_GUILESS_MAIN(WordGeneratorTest)
+#include "WordGeneratorTest.moc"